@@ -0,0 +1,46 @@
+#include "Benchmarks.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+
+// Replaces the global allocation functions for the whole benchmark binary so runs can
+// report how many heap allocations each message costs. Allocations made by libzmq
+// itself use malloc directly and are not counted.
+namespace {
+    std::atomic<uint64_t> allocations{ 0 };
+}
+
+namespace StockTracker::Bench {
+    uint64_t allocationCount() {
+        return allocations.load(std::memory_order_relaxed);
+    }
+}
+
+void* operator new(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    std::free(p);
+}
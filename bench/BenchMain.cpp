@@ -0,0 +1,53 @@
+#include "Benchmarks.h"
+#include <iostream>
+#include <map>
+#include <stdexcept>
+
+
+namespace {
+    using BenchFn = int (*)(const std::vector<std::string>&);
+
+    const std::map<std::string, BenchFn>& benchmarks() {
+        static const std::map<std::string, BenchFn> all = {
+            { "wire", &StockTracker::Bench::runWireFormatBench },
+            { "replay", &StockTracker::Bench::runReplayBench },
+            { "correlation", &StockTracker::Bench::runCorrelationBench },
+        };
+        return all;
+    }
+
+    void printUsage(const std::string& program) {
+        std::cout << "Usage: " << program << " <benchmark> [options]\n"
+            << "Benchmarks:\n"
+            << "  wire [iterations]    Decode cost per message, JSON vs binary\n"
+            << "  replay [messages] [symbols] [rate] [tick dir]\n"
+            << "                       Quotes from a mock DataService through the real update path:\n"
+            << "                       throughput, latency percentiles and allocations per message.\n"
+            << "                       rate is messages/s (0 = unpaced); tick dir replays recorded ticks\n"
+            << "  correlation [symbols] [window] [rounds]\n"
+            << "                       Correlation matrix rebuild and per-bucket refresh:\n"
+            << "                       scalar vs SIMD kernels, one core vs all\n";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    auto it = benchmarks().find(argv[1]);
+    if (it == benchmarks().end()) {
+        std::cerr << "Unknown benchmark: " << argv[1] << std::endl;
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    try {
+        return it->second(std::vector<std::string>(argv + 2, argv + argc));
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+namespace StockTracker::Bench {
+
+	// Runs `op` `iterations` times and returns the mean cost in nanoseconds.
+	template <typename Op>
+	double nsPerOp(size_t iterations, Op&& op) {
+		const auto start = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < iterations; ++i) {
+			op(i);
+		}
+		const auto elapsed = std::chrono::steady_clock::now() - start;
+		return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) / iterations;
+	}
+
+	// Heap allocations made through operator new so far, by any thread.
+	uint64_t allocationCount();
+
+	// Each benchmark takes the arguments that follow its name and returns a process exit code.
+	int runWireFormatBench(const std::vector<std::string>& args);
+	int runReplayBench(const std::vector<std::string>& args);
+	int runCorrelationBench(const std::vector<std::string>& args);
+}
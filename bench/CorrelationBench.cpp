@@ -0,0 +1,119 @@
+#include "Benchmarks.h"
+#include "CorrelationMatrix.h"
+#include "QuoteStore.h"
+#include "ThreadAffinity.h"
+#include "VectorKernels.h"
+#include "WorkerPool.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+
+
+namespace StockTracker::Bench {
+    namespace {
+        constexpr int64_t BUCKET_NS = 1'000'000'000;
+
+        // Returns driven by one common factor plus noise, so the matrix isn't all zeros
+        std::vector<double> syntheticRows(size_t symbols, size_t stride, size_t window) {
+            std::mt19937 rng(42);
+            std::normal_distribution<double> noise(0.0, 0.01);
+            std::vector<double> rows(symbols * stride, 0.0);
+            for (size_t t = 0; t < window; ++t) {
+                const double factor = noise(rng);
+                for (size_t s = 0; s < symbols; ++s) {
+                    rows[s * stride + t] = factor * static_cast<double>(s % 4) * 0.5 + noise(rng);
+                }
+            }
+            return rows;
+        }
+
+        double gramMs(const std::vector<double>& rows, size_t symbols, size_t stride, std::vector<double>& out,
+            const VectorKernels& kernels, WorkerPool* pool, size_t rounds)
+        {
+            return nsPerOp(rounds, [&](size_t) {
+                CorrelationMatrix::gram(rows.data(), symbols, stride, out.data(), kernels, pool);
+            }) / 1e6;
+        }
+
+        // Mean cost of one bucket through CorrelationMatrix::advance: sampling the store and the
+        // incremental update. Every `window` buckets that is a full rebuild instead.
+        double advanceUs(QuoteStore& stocks, const std::vector<std::string>& symbols, const VectorKernels& kernels,
+            size_t window, size_t buckets)
+        {
+            CorrelationMatrix matrix(stocks, BUCKET_NS, window, kernels, 1);
+            std::mt19937 rng(7);
+            std::normal_distribution<double> noise(0.0, 0.01);
+            std::vector<double> prices(symbols.size(), 100.0);
+            int64_t bucket = 1'000'000;
+            matrix.advance(bucket * BUCKET_NS); // Backfill and first rebuild, not timed
+
+            int64_t total_ns = 0;
+            for (size_t b = 0; b < buckets; ++b) {
+                ++bucket;
+                for (size_t s = 0; s < symbols.size(); ++s) {
+                    prices[s] *= std::exp(noise(rng));
+                    QuoteTick tick{};
+                    tick.symbol = symbols[s];
+                    tick.key = symbolKey(symbols[s]);
+                    tick.price = prices[s];
+                    tick.timestamp_ns = bucket * BUCKET_NS;
+                    bool claimed = false;
+                    stocks.apply(tick, 0, claimed);
+                }
+                const auto start = std::chrono::steady_clock::now();
+                matrix.advance(bucket * BUCKET_NS);
+                total_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+            }
+            return static_cast<double>(total_ns) / static_cast<double>(std::max<size_t>(buckets, 1)) / 1000.0;
+        }
+    }
+
+    int runCorrelationBench(const std::vector<std::string>& args) {
+        const size_t symbol_count = args.size() > 0 ? std::stoul(args[0]) : 500;
+        const size_t window = args.size() > 1 ? std::max<size_t>(2, std::stoul(args[1])) : 120;
+        const size_t rounds = args.size() > 2 ? std::stoul(args[2]) : 20;
+        const size_t stride = (window + 3) & ~size_t{ 3 };
+        const size_t cores = coreCount();
+
+        // Full rebuild: the N x N upper triangle of dot products
+        const std::vector<double> rows = syntheticRows(symbol_count, stride, window);
+        std::vector<double> scalar_out(symbol_count * symbol_count, 0.0);
+        std::vector<double> simd_out(symbol_count * symbol_count, 0.0);
+        WorkerPool pool(cores - 1);
+        const double scalar_ms = gramMs(rows, symbol_count, stride, scalar_out, VectorKernels::scalar(), nullptr, rounds);
+        const double simd_ms = gramMs(rows, symbol_count, stride, simd_out, VectorKernels::simd(), nullptr, rounds);
+        const double threaded_ms = gramMs(rows, symbol_count, stride, simd_out, VectorKernels::simd(), &pool, rounds);
+
+        // Relative to the rows' norms, i.e. as an error in the correlation
+        double max_error = 0.0;
+        for (size_t i = 0; i < symbol_count; ++i) {
+            for (size_t j = i; j < symbol_count; ++j) {
+                const double a = scalar_out[i * symbol_count + j];
+                const double b = simd_out[i * symbol_count + j];
+                const double norms = std::sqrt(scalar_out[i * symbol_count + i] * scalar_out[j * symbol_count + j]);
+                max_error = std::max(max_error, std::abs(a - b) / std::max(norms, 1e-300));
+            }
+        }
+
+        // Per-bucket refresh through the real sampling path
+        QuoteStore stocks(64);
+        std::vector<std::string> symbols;
+        for (size_t s = 0; s < symbol_count; ++s) {
+            symbols.push_back("S" + std::to_string(s));
+        }
+        stocks.add(symbols);
+        const size_t buckets = window * 2;
+        const double scalar_us = advanceUs(stocks, symbols, VectorKernels::scalar(), window, buckets);
+        const double simd_us = advanceUs(stocks, symbols, VectorKernels::simd(), window, buckets);
+
+        std::printf("Correlation matrix, %zu symbols x %zu returns (%s kernels)\n", symbol_count, window, VectorKernels::simd().name);
+        std::printf("  full rebuild      scalar %8.3f ms   simd %8.3f ms (%.1fx)   simd x%zu threads %8.3f ms (%.1fx)\n",
+            scalar_ms, simd_ms, scalar_ms / simd_ms, pool.threads(), threaded_ms, scalar_ms / threaded_ms);
+        std::printf("  per bucket        scalar %8.1f us   simd %8.1f us (%.1fx), %zu buckets incl. rebuilds every %zu\n",
+            scalar_us, simd_us, scalar_us / simd_us, buckets, window);
+        std::printf("  simd vs scalar    max relative difference %.2e\n", max_error);
+        return max_error < 1e-9 ? 0 : 2;
+    }
+}
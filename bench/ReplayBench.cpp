@@ -0,0 +1,287 @@
+#include "Benchmarks.h"
+#include "CliApp.h"
+#include "TickStore.h"
+#include "Topics.h"
+#include "WireFormat.h"
+#include <StockTracker/Messages.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <zmq.hpp>
+
+
+namespace StockTracker::Bench {
+    namespace {
+        constexpr const char* FEED_ENDPOINT = "inproc://replay-feed";
+        constexpr const char* REQUEST_ENDPOINT = "inproc://replay-requests";
+        constexpr auto IDLE_TIMEOUT = std::chrono::seconds(2); // Give up on ticks that never arrive
+
+        struct ReplayTick {
+            std::string symbol;
+            double price;
+            double volume;
+        };
+
+        // The presenter's output is formatted as usual and then thrown away here.
+        class NullBuffer : public std::streambuf {
+        protected:
+            int overflow(int c) override { return c; }
+            std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+        };
+
+        int64_t steadyNs() {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        // "AAAAA", "AAAAB", ... so synthetic symbols look like real ones
+        std::string syntheticSymbol(size_t i) {
+            std::string symbol(5, 'A');
+            for (size_t at = symbol.size(); at-- > 0 && i > 0; i /= 26) {
+                symbol[at] = static_cast<char>('A' + i % 26);
+            }
+            return symbol;
+        }
+
+        std::vector<ReplayTick> syntheticStream(size_t symbols) {
+            // A few ticks per symbol with a small random walk, interleaved across symbols
+            std::vector<ReplayTick> stream;
+            for (size_t round = 0; round < 16; ++round) {
+                for (size_t s = 0; s < symbols; ++s) {
+                    const double base = 50.0 + static_cast<double>(s % 400);
+                    const double step = static_cast<double>((round * 7 + s * 13) % 21) - 10.0;
+                    stream.push_back({ syntheticSymbol(s), base + step * 0.05, 100.0 + static_cast<double>(round) });
+                }
+            }
+            return stream;
+        }
+
+        // Every *.ticks file in `directory`, interleaved round-robin in file order
+        std::vector<ReplayTick> recordedStream(const std::string& directory) {
+            const TickStore store(directory);
+            std::vector<std::string> symbols;
+            for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+                if (entry.path().extension() == ".ticks") {
+                    symbols.push_back(entry.path().stem().string());
+                }
+            }
+
+            std::vector<std::vector<ReplayTick>> per_symbol;
+            size_t longest = 0;
+            for (const auto& symbol : symbols) {
+                const auto range = store.newest(symbol, std::numeric_limits<size_t>::max());
+                auto& ticks = per_symbol.emplace_back();
+                for (const TickRecord& record : range.records()) {
+                    ticks.push_back({ symbol, record.price, record.volume });
+                }
+                longest = std::max(longest, ticks.size());
+            }
+
+            std::vector<ReplayTick> stream;
+            for (size_t i = 0; i < longest; ++i) {
+                for (const auto& ticks : per_symbol) {
+                    if (i < ticks.size()) {
+                        stream.push_back(ticks[i]);
+                    }
+                }
+            }
+            if (stream.empty()) {
+                throw std::runtime_error("no recorded ticks in " + directory);
+            }
+            return stream;
+        }
+
+        // Stands in for the DataService: answers the handshake on the control topic and
+        // publishes quotes as binary frames on their symbol topics.
+        class MockPublisher {
+        public:
+            MockPublisher(zmq::context_t& context, std::vector<std::string> symbols)
+                : feed(context, zmq::socket_type::pub)
+                , requests(context, zmq::socket_type::sub)
+                , symbols(std::move(symbols))
+            {
+                feed.set(zmq::sockopt::sndhwm, 0); // Measure the pipeline, not ZMQ's drop policy
+                feed.bind(FEED_ENDPOINT);
+            }
+
+            // After the app has bound its request endpoint
+            void connectRequests() {
+                requests.set(zmq::sockopt::subscribe, "");
+                requests.connect(REQUEST_ENDPOINT);
+            }
+
+            // Replies to any RequestSubscriptions received so far
+            void answerRequests() {
+                zmq::message_t part;
+                while (requests.recv(part, zmq::recv_flags::dontwait)) {
+                    do {
+                        const Message request = Message::deserialize(part.to_string());
+                        if (request.type == MessageType::RequestSubscriptions) {
+                            Message reply;
+                            reply.type = MessageType::SubscriptionsList;
+                            reply.subscriptions = symbols;
+                            const std::string payload = reply.serialize();
+                            feed.send(zmq::buffer(Topics::CONTROL), zmq::send_flags::sndmore);
+                            feed.send(zmq::buffer(payload), zmq::send_flags::none);
+                        }
+                    } while (part.more() && requests.recv(part));
+                }
+            }
+
+            void publish(const ReplayTick& replay) {
+                QuoteTick tick;
+                tick.symbol = replay.symbol;
+                tick.currency = "USD";
+                tick.timestamp_ns = steadyNs(); // Send time, read back by the tick observer
+                tick.price = replay.price;
+                tick.volume = replay.volume;
+                tick.sequence = ++sequences[replay.symbol]; // Lets the app detect its own drops
+
+                topic.assign("Q:").append(replay.symbol).push_back(';');
+                Wire::encodeQuote(tick, frame);
+                feed.send(zmq::buffer(topic), zmq::send_flags::sndmore);
+                feed.send(zmq::buffer(frame), zmq::send_flags::none);
+            }
+
+        private:
+            zmq::socket_t feed;
+            zmq::socket_t requests;
+            std::vector<std::string> symbols;
+            std::unordered_map<std::string, uint64_t> sequences;
+            std::string topic; // Reused so publishing allocates nothing on our side
+            std::string frame;
+        };
+
+        double percentile(const std::vector<int64_t>& sorted, double p) {
+            if (sorted.empty()) {
+                return 0.0;
+            }
+            const size_t at = std::min(sorted.size() - 1, static_cast<size_t>(p * static_cast<double>(sorted.size())));
+            return static_cast<double>(sorted[at]) / 1000.0;
+        }
+    }
+
+    int runReplayBench(const std::vector<std::string>& args) {
+        const size_t messages = args.size() > 0 ? std::stoul(args[0]) : 200000;
+        const size_t symbol_count = args.size() > 1 ? std::stoul(args[1]) : 100;
+        const double rate = args.size() > 2 ? std::stod(args[2]) : 0.0; // Messages per second, 0 = unpaced
+        const std::vector<ReplayTick> stream = args.size() > 3 ? recordedStream(args[3]) : syntheticStream(symbol_count);
+
+        std::vector<std::string> symbols;
+        for (const auto& tick : stream) {
+            if (std::find(symbols.begin(), symbols.end(), tick.symbol) == symbols.end()) {
+                symbols.push_back(tick.symbol);
+            }
+        }
+
+        CliConfig config;
+        config.cache_path.clear();
+        config.tick_dir.clear();
+        config.request_endpoints = { REQUEST_ENDPOINT };
+        config.feed_endpoints = { FEED_ENDPOINT };
+
+        NullBuffer null_buffer;
+        std::streambuf* console = std::cout.rdbuf(&null_buffer);
+
+        zmq::context_t context(1);
+        MockPublisher publisher(context, symbols);
+        auto app = std::make_unique<CliApp>(config, context);
+        publisher.connectRequests();
+
+        // Single writer: the observer runs on the app's one feed worker
+        std::vector<int64_t> latencies(messages + 1);
+        std::atomic<size_t> observed{ 0 };
+        std::atomic<bool> measuring{ false };
+        app->setTickObserver([&](const QuoteTick& tick) {
+            if (!measuring.load(std::memory_order_relaxed)) {
+                observed.store(1, std::memory_order_release); // Warm-up tick arrived
+                return;
+            }
+            const size_t n = observed.load(std::memory_order_relaxed);
+            if (n < latencies.size()) {
+                latencies[n] = steadyNs() - tick.timestamp_ns;
+            }
+            observed.store(n + 1, std::memory_order_release);
+        });
+        app->start();
+
+        // Handshake, then warm-up ticks on the last topic filter the app sets until one arrives
+        const auto warmup_deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (observed.load(std::memory_order_acquire) == 0) {
+            if (std::chrono::steady_clock::now() > warmup_deadline) {
+                app.reset();
+                std::cout.rdbuf(console);
+                std::cerr << "The app never received a quote" << std::endl;
+                return 1;
+            }
+            publisher.answerRequests();
+            publisher.publish({ symbols.back(), 1.0, 0.0 });
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50)); // Let warm-up ticks drain
+        observed.store(0);
+        measuring = true;
+
+        const uint64_t allocations_before = allocationCount();
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < messages; ++i) {
+            if (rate > 0.0) {
+                const auto due = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                    std::chrono::duration<double>(static_cast<double>(i) / rate));
+                while (std::chrono::steady_clock::now() < due) {
+                    std::this_thread::yield();
+                }
+            }
+            publisher.publish(stream[i % stream.size()]);
+        }
+
+        // Wait for the pipeline to catch up, or to stop making progress
+        size_t seen = 0;
+        auto last_progress = std::chrono::steady_clock::now();
+        while (seen < messages && std::chrono::steady_clock::now() - last_progress < IDLE_TIMEOUT) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            const size_t now_seen = observed.load(std::memory_order_acquire);
+            if (now_seen != seen) {
+                seen = now_seen;
+                last_progress = std::chrono::steady_clock::now();
+            }
+        }
+        // Up to the last tick seen, so ticks that never arrive don't add the idle timeout
+        const auto elapsed = last_progress - start;
+        const uint64_t allocations = allocationCount() - allocations_before;
+
+        app.reset(); // Its output writer finishes into the null buffer
+        std::cout.rdbuf(console);
+
+        latencies.resize(std::min(seen, messages));
+        std::sort(latencies.begin(), latencies.end());
+        const double seconds = std::chrono::duration<double>(elapsed).count();
+
+        std::printf("Replay through processUpdates/updateStockData\n");
+        std::printf("  messages   %zu sent, %zu applied\n", messages, latencies.size());
+        if (latencies.size() < messages) {
+            std::printf("  lost       %zu, none seen in the last %lld s\n", messages - latencies.size(),
+                static_cast<long long>(IDLE_TIMEOUT.count()));
+        }
+        std::printf("  symbols    %zu (%s)\n", symbols.size(), args.size() > 3 ? "recorded" : "synthetic");
+        std::printf("  rate       %s\n", rate > 0.0 ? (std::to_string(static_cast<size_t>(rate)) + " msg/s").c_str() : "unpaced");
+        std::printf("  throughput %.0f msg/s applied\n", static_cast<double>(latencies.size()) / seconds);
+        std::printf("  latency us p50 %.1f  p90 %.1f  p99 %.1f  p99.9 %.1f  max %.1f\n",
+            percentile(latencies, 0.50), percentile(latencies, 0.90), percentile(latencies, 0.99),
+            percentile(latencies, 0.999), percentile(latencies, 1.0));
+        std::printf("  allocations %.2f per message (operator new, all threads)\n",
+            static_cast<double>(allocations) / static_cast<double>(std::max<size_t>(messages, 1)));
+        return latencies.size() == messages ? 0 : 2;
+    }
+}
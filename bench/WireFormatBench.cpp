@@ -0,0 +1,102 @@
+#include "Benchmarks.h"
+#include "WireFormat.h"
+#include <StockTracker/Messages.h>
+#include <cstdio>
+#include <string>
+
+
+namespace StockTracker::Bench {
+    namespace {
+        StockQuote makeQuote(size_t i) {
+            StockQuote quote;
+            quote.symbol = "AAPL";
+            quote.price = 190.0 + static_cast<double>(i % 100) * 0.01;
+            quote.change_percent = 0.42;
+            quote.currency = "USD";
+            quote.timestamp = std::chrono::system_clock::now();
+            return quote;
+        }
+
+        struct Result {
+            double json_ns;
+            double binary_ns;
+        };
+
+        // Both paths start from the raw frame bytes, as drainUpdates sees them. The
+        // JSON path pays for the string copy and the parse; the binary path for
+        // validation and reading the fields.
+        Result measure(const std::string& json, const std::string& binary, size_t iterations) {
+            volatile double sink = 0.0;
+
+            const double json_ns = nsPerOp(iterations, [&](size_t) {
+                const Message msg = Message::deserialize(std::string(json.data(), json.size()));
+                if (msg.quote) {
+                    sink = sink + toTick(*msg.quote).price;
+                }
+                else if (msg.priceHistory) {
+                    for (const auto& quote : *msg.priceHistory) {
+                        sink = sink + toTick(quote).price;
+                    }
+                }
+            });
+
+            const double binary_ns = nsPerOp(iterations, [&](size_t) {
+                if (auto frame = Wire::FrameView::parse(binary.data(), binary.size())) {
+                    for (const QuoteTick tick : *frame) {
+                        sink = sink + tick.price;
+                    }
+                }
+            });
+
+            return { json_ns, binary_ns };
+        }
+
+        void report(const char* name, size_t json_bytes, size_t binary_bytes, const Result& result) {
+            std::printf("  %-20s %8zu B %10.1f ns   %8zu B %10.1f ns   %6.1fx\n",
+                name, json_bytes, result.json_ns, binary_bytes, result.binary_ns, result.json_ns / result.binary_ns);
+        }
+    }
+
+    int runWireFormatBench(const std::vector<std::string>& args) {
+        const size_t iterations = args.empty() ? 200000 : std::stoul(args[0]);
+
+        // Single quote
+        Message quote_msg;
+        quote_msg.type = MessageType::QuoteUpdate;
+        quote_msg.quote = makeQuote(0);
+        const std::string quote_json = quote_msg.serialize();
+        std::string quote_binary;
+        Wire::encodeQuote(toTick(*quote_msg.quote), quote_binary);
+
+        // Price history response, the size the DataService usually replies with and a long one
+        auto history = [](size_t points, std::string& json, std::string& binary) {
+            Message msg;
+            msg.type = MessageType::PriceHistoryResponse;
+            msg.symbol = "AAPL";
+            msg.priceHistory.emplace();
+            std::vector<QuoteTick> ticks;
+            for (size_t i = 0; i < points; ++i) {
+                msg.priceHistory->push_back(makeQuote(i));
+            }
+            for (const auto& quote : *msg.priceHistory) {
+                ticks.push_back(toTick(quote));
+            }
+            json = msg.serialize();
+            Wire::encodeHistory(msg.symbol, ticks, binary);
+        };
+
+        std::string history15_json, history15_binary, history1k_json, history1k_binary;
+        history(15, history15_json, history15_binary);
+        history(1000, history1k_json, history1k_binary);
+
+        std::printf("Decode cost per message (%zu iterations)\n", iterations);
+        std::printf("  %-20s %10s %13s   %10s %13s   %7s\n", "message", "json", "", "binary", "", "speedup");
+        report("QuoteUpdate", quote_json.size(), quote_binary.size(),
+            measure(quote_json, quote_binary, iterations));
+        report("PriceHistory x15", history15_json.size(), history15_binary.size(),
+            measure(history15_json, history15_binary, iterations / 10));
+        report("PriceHistory x1000", history1k_json.size(), history1k_binary.size(),
+            measure(history1k_json, history1k_binary, iterations / 1000 + 1));
+        return 0;
+    }
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include "FlatSymbolMap.h"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+
+namespace StockTracker {
+
+	enum class AlertCondition {
+		Above,   // Price goes over the threshold
+		Below,   // Price goes under the threshold
+		Crosses, // A move reaches or passes the threshold, either way
+	};
+
+	std::optional<AlertCondition> parseAlertCondition(std::string_view text);
+	std::string_view alertConditionName(AlertCondition condition);
+
+	struct Alert {
+		uint64_t id{ 0 };
+		SymbolKey symbol{ NO_SYMBOL };
+		AlertCondition condition{ AlertCondition::Above };
+		double threshold{ 0.0 }; // In the quote's own currency
+	};
+
+	struct FiredAlert {
+		Alert alert;
+		double price{ 0.0 };
+		int64_t timestamp_ns{ 0 };
+	};
+
+	// One-shot price alerts, checked against every applied quote.
+	//
+	// Each symbol keeps its thresholds in one sorted map per condition, so a quote only
+	// touches the alerts it triggers: Above alerts below the new price are a prefix,
+	// Below alerts above it a suffix, and Crosses alerts a range between the previous
+	// and new price. A check is O(log n + k) for k fired alerts, which are removed.
+	// Symbols without alerts cost one flat-table probe. Update thread only.
+	class AlertBook {
+	public:
+		// `price` seeds the previous price for Crosses, if the symbol has none yet.
+		void add(const Alert& alert, std::optional<double> price);
+		bool remove(uint64_t id);
+		size_t clear();
+
+		// Appends the alerts `price` triggers to `fired`, oldest id first per condition.
+		void check(SymbolKey symbol, double price, int64_t timestamp_ns, std::vector<FiredAlert>& fired);
+
+		// The symbol stopped being received; its next price is not a move from the last one.
+		void forgetPrice(SymbolKey symbol);
+
+		void list(std::vector<Alert>& out) const; // By id
+		size_t size() const { return alerts.size(); }
+
+	private:
+		using Thresholds = std::multimap<double, uint64_t>; // Threshold -> alert id
+
+		struct SymbolAlerts {
+			Thresholds above;
+			Thresholds below;
+			Thresholds crosses;
+			std::optional<double> last_price;
+		};
+
+		Thresholds& thresholds(SymbolAlerts& entry, AlertCondition condition);
+		template <typename Iterator>
+		void fire(Thresholds& map, Iterator first, Iterator last, double price, int64_t timestamp_ns,
+			std::vector<FiredAlert>& fired);
+
+		std::unordered_map<uint64_t, Alert> alerts;
+		FlatSymbolMap<SymbolAlerts*> symbols;
+		std::deque<SymbolAlerts> storage; // Stable addresses for `symbols`; kept once created
+	};
+}
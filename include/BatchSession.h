@@ -0,0 +1,91 @@
+#pragma once
+#include "OutputQueue.h"
+#include "QuoteFields.h"
+#include <StockTracker/Messages.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+
+namespace StockTracker {
+
+	enum class BatchFormat {
+		Csv,
+		JsonLines,
+	};
+
+	// What a reply said about the request it answers.
+	struct BatchReply {
+		std::string status{ "ok" };
+		std::optional<double> price;
+		std::optional<double> change_percent;
+		std::string currency;
+		int64_t timestamp_ns{ 0 };
+		size_t points{ 0 }; // Ticks in a history reply
+
+		static BatchReply fromTick(const QuoteTick& tick);
+	};
+
+	// Book-keeping for --batch/--script runs. Every request (one per symbol of a command)
+	// gets an id when it is sent; the DataService's replies carry no id of their own, so a
+	// reply is matched to the oldest outstanding request expecting that reply type for that
+	// symbol. Each result is one CSV or JSON line, in the order the replies arrive.
+	//
+	// expect()/complete()/finish() are called by the script thread, resolve() by the update
+	// thread. Results are formatted by whichever thread learns them and written by the
+	// script thread on its next call, waiting for room in the output queue rather than
+	// dropping them, so the update thread never blocks on output.
+	class BatchSession {
+	public:
+		BatchSession(OutputQueue& output, BatchFormat format);
+
+		// Registers a request before it is sent, so its reply can't arrive first. `services`
+		// is how many DataServices it goes to; it only fails once every one of them has
+		// answered with an error. Returns the request's id.
+		size_t expect(const std::string& command, const std::string& symbol, MessageType reply, size_t services = 1);
+
+		// A result known without waiting for the DataService.
+		void complete(const std::string& command, const std::string& symbol, const BatchReply& reply);
+
+		// Returns false if no request is waiting for this reply.
+		bool resolve(MessageType type, std::string_view symbol, const BatchReply& reply);
+		bool resolveError(std::string_view symbol, const std::string& error); // Any request type
+
+		// Waits for every outstanding reply or the deadline, then reports the rest as
+		// timed out. Returns true if every request succeeded.
+		bool finish(std::chrono::steady_clock::time_point deadline);
+
+	private:
+		struct Pending {
+			size_t id;
+			std::string command;
+			std::string symbol;
+			std::chrono::steady_clock::time_point sent;
+			size_t errors_left{ 1 }; // Services that may still answer with an error
+		};
+		using Key = std::pair<MessageType, SymbolKey>;
+
+		void write(const Pending& request, const BatchReply& reply); // Called with `mutex` held
+		void flush(); // Script thread only
+
+		OutputQueue& output;
+		const BatchFormat format;
+
+		std::mutex mutex;
+		std::condition_variable replied;
+		std::map<Key, std::deque<Pending>> pending;
+		std::deque<std::string> rows; // Formatted results not yet handed to `output`
+		std::map<SymbolKey, size_t> stray_errors; // Other services' errors for requests already answered
+		size_t next_id{ 1 };
+		size_t outstanding{ 0 };
+		bool failed{ false };
+	};
+}
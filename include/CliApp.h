@@ -1,9 +1,35 @@
 #pragma once
 #include <StockTracker/Messages.h>
 #include <StockTracker/CurrencyService.h>
-#include <unordered_map>
-#include <deque>
+#include "AlertBook.h"
+#include "BatchSession.h"
+#include "CliConfig.h"
+#include "Conflator.h"
+#include "CorrelationMatrix.h"
+#include "Dashboard.h"
+#include "FeedShard.h"
+#include "FxTable.h"
+#include "GraphRasterizer.h"
+#include "Metrics.h"
+#include "OutputQueue.h"
+#include "QuoteStore.h"
+#include "RankIndex.h"
+#include "SequenceTracker.h"
+#include "TickStore.h"
+#include "WireFormat.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <iostream>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ostream>
 #include <thread>
+#include <unordered_set>
+#include <vector>
 #include <zmq.hpp>
 
 
@@ -21,11 +47,18 @@ namespace Commands {
 	constexpr auto Query = hash("query");
 	constexpr auto Graph = hash("graph");
 	constexpr auto List = hash("list");
+	constexpr auto Top = hash("top");
+	constexpr auto Alert = hash("alert");
 	constexpr auto History = hash("history");
 	constexpr auto Help = hash("help");
 	constexpr auto Exit = hash("exit");
 	constexpr auto Clear = hash("clear");
 	constexpr auto SetCurrency = hash("currency");
+	constexpr auto Watch = hash("watch");
+	constexpr auto Stats = hash("stats");
+	constexpr auto Corr = hash("corr");
+	constexpr auto Beta = hash("beta");
+	constexpr auto Metrics = hash("metrics");
 }
 
 
@@ -33,62 +66,198 @@ namespace StockTracker {
 
 	class CliApp {
 	private:
-		MessageSocket publisher;
-		MessageSocket subscriber;
+		CliConfig config;
 
-		mutable CurrencyService currency_service;
-		std::string display_currency{ "USD" }; // Default currency.
+		// Every thread's terminal output and log lines are queued here and written by the
+		// queue's own thread, so a slow terminal never stalls ingest.
+		OutputQueue output{ std::cout };
+		LogRoute log_route{ output };
 
+		std::unique_ptr<zmq::context_t> owned_context; // Null when the caller supplies the context
+		zmq::context_t& context;
 
-		// Stock data
-		struct StockData {
-			double current_price{ 0.0 };
-			double change_percent{ 0.0 };
-			std::string currency{ "USD" };
-			std::deque<double> price_history;
-			static constexpr size_t MAX_HISTORY = 15;
-		};
+		// Requests to the DataServices, one socket per configured request endpoint. Used from
+		// the input thread and every shard worker.
+		std::vector<zmq::socket_t> publishers;
+		std::mutex publisher_mutex;
 
-		std::unordered_map<std::string, StockData> stocks;
+		// One shard per feed endpoint, each ingested by its own worker thread (the "update
+		// thread" below means the shard's worker). Workers are optionally pinned to cores.
+		std::vector<std::unique_ptr<FeedShard>> shards;
+		static constexpr size_t MAX_DRAIN_BATCH = 4096; // Messages handled per wakeup before re-polling
+		void postToShards(std::function<void(FeedShard&)> task);
+
+		// Startup handshake, per shard. PUB/SUB drops whatever is sent before the connection
+		// is up, so RequestSubscriptions is resent with exponential backoff until the
+		// shard's SubscriptionsList reply arrives or config.connect_attempts is used up.
+		static constexpr std::chrono::milliseconds HANDSHAKE_FIRST_RETRY{ 25 };
+		static constexpr std::chrono::milliseconds HANDSHAKE_MAX_RETRY{ 2000 };
+		std::atomic<size_t> settled_shards{ 0 }; // Handshakes finished, for the batch thread
+		std::chrono::milliseconds advanceHandshake(FeedShard& shard);
+		void settleHandshake(FeedShard& shard);
+
+		// Ticks lost to the feed's high-water mark show up as sequence gaps. The symbol's
+		// history is then requested again, at most once per RESYNC_RETRY while a request
+		// is outstanding, and the reply replaces the in-memory history quietly. Requests
+		// found during a drain go out as one batch at its end.
+		static constexpr std::chrono::seconds RESYNC_RETRY{ 5 };
+		void noteGap(FeedShard& shard, const QuoteTick& tick, const SequenceCheck& check);
+		template <typename History>
+		bool completeResync(FeedShard& shard, std::string_view symbol, const History& history);
+
+		// History the user asked for and hasn't been shown yet, per symbol. A reply that
+		// also completes a resync is still printed if the user is waiting for it.
+		std::mutex history_requests_mutex;
+		FlatSymbolMap<size_t> history_requests; // Guarded by history_requests_mutex
+		bool takeHistoryRequest(SymbolKey key);
+
+		// Prices are converted for display with rates cached in fx_rates, so rendering
+		// never calls the service, throws or compares currency strings.
+		CurrencyService currency_service;
+		FxTable fx_rates{ currency_service, std::chrono::seconds(config.fx_ttl_s) };
+		std::atomic<CurrencyId> display_currency{ Currencies::USD }; // Default currency.
+
+
+		// Stock data, written by the shard workers and read by the input thread.
+		QuoteStore stocks;
+		TickSeries graph_series; // Input thread scratch copy for graphing
+		GraphRasterizer graph_rasterizer; // Input thread only, reuses its buffers
+
+		// Correlation and beta of returns across symbols. The presenter thread samples every
+		// price once per config.corr_interval_ms; 'corr' and 'beta' read the result.
+		// Rebuild threads are pinned past the feed workers' cores
+		CorrelationMatrix correlations{ stocks, static_cast<int64_t>(config.corr_interval_ms) * 1000000, config.corr_window,
+			VectorKernels::simd(), 0,
+			config.pin_workers ? std::optional<size_t>(config.feed_endpoints.size() + 1) : std::nullopt };
+		std::vector<CorrelationMatrix::Pair> correlation_pairs; // Input thread scratch for 'corr'
+		static constexpr size_t CORR_PAIRS = 10;       // Pairs 'corr' lists
+		static constexpr size_t CORR_MATRIX_MAX = 10;  // Symbols 'corr' shows side by side
+		void showCorrelations(const std::vector<std::string>& args);
+		void showBeta(const std::string& symbol, const std::string& index);
+
+		// Every received tick, on disk. Written by the shard workers, read by 'history' and
+		// 'graph'. Null when disabled or the directory can't be used.
+		std::unique_ptr<TickStore> tick_store;
+		static constexpr size_t HISTORY_LINES = 15; // Ticks 'history' prints, as many as the DataService sends
+		static constexpr size_t GRAPH_HEIGHT = 11; // Text rows of plot area
+		static constexpr size_t GRAPH_WINDOW = 1; // Index into STATS_WINDOWS; its running min/max scale the graph
+		static constexpr size_t GRAPH_POINTS = STATS_WINDOWS[GRAPH_WINDOW]; // Newest ticks drawn by 'graph'
 		std::atomic<bool> running{ true };
+		std::thread presenter_thread;
+		void startWorkers();
+		void joinThreads();
+
+		// Called on the shard's worker for every applied quote. Set before start(); used by
+		// the replay benchmark to time the pipeline.
+		std::function<void(const QuoteTick&)> tick_observer;
+
+		// Workers only apply quotes and record them in their shard's conflator. The
+		// presenter thread drains one coalesced batch per interval from every shard and
+		// prints it, or redraws the 'watch' dashboard, so display cost no longer scales
+		// with tick rate.
+		std::mutex presenter_mutex;
+		std::condition_variable presenter_cv;
+		bool dashboard_active{ false }; // Guarded by presenter_mutex
+
+		// Subscribed symbols in order by change, price, volume and name, updated with every
+		// applied quote in the shard's index. 'list', 'top' and the dashboard read one page
+		// of them merged. Symbols restored from the cache are ranked in restored_rankings
+		// until a shard claims them.
+		RankIndex restored_rankings;
+		std::vector<const RankIndex*> ranking_views; // restored_rankings, then each shard's
+		void takeOverRanking(FeedShard& shard, std::string_view symbol); // After a history reply's claim
+		std::vector<RankIndex::Row> list_rows; // Input thread scratch for 'list'
+		std::vector<RankIndex::Row> dashboard_rows; // Presenter thread scratch
+		std::vector<std::string> dashboard_symbols; // Presenter thread scratch, while some are unranked
+		static constexpr size_t LIST_PAGE_SIZE = 20; // Rows per 'list ... page <n>' without 'top <n>'
+		static constexpr size_t TOP_DEFAULT = 10;
+
+		// Price alerts, checked against every applied quote. Each shard's worker owns a copy
+		// of the book, changed through postToShards; whichever shard owns the symbol fires
+		// it and removes it from the others. Fired alerts are handed to the presenter to
+		// print, so ingest never formats or writes them.
+		std::mutex alert_mutex;
+		std::vector<FiredAlert> alert_outbox; // Guarded by alert_mutex
+		uint64_t next_alert_id{ 1 };          // Input thread only
+		void alertCommand(const std::vector<std::string>& args);
+		void printAlerts(const std::vector<FiredAlert>& fired);
+
+		// Latency from feed to screen, counters and queue depths. Ingest stages are kept per
+		// shard and the presenter's here, each written by one thread and merged for display.
+		PipelineMetrics metrics;
+		std::unique_ptr<PipelineMetrics> mergedMetrics() const;
+		void showMetrics();
+
+		// While watching, update-thread output is discarded so it doesn't scroll the dashboard.
+		std::atomic<bool> watching{ false };
+		OutputQueue::Line updateOutput();
+
+		// Set for the whole of runBatch(), before the update thread starts. Replies are
+		// matched to the script's requests here instead of being printed.
+		std::unique_ptr<BatchSession> batch;
+		void runBatchCommand(const std::string& line);
 
 
 		void handleCommand(const std::string & cmd);
-		void processUpdates();
+		void processUpdates(FeedShard& shard);
+		void presentUpdates();
+		void printBatch(const std::vector<ConflatedQuote>& batch);
+		void setDashboardActive(bool active);
+		size_t drainUpdates(FeedShard& shard);
+		void handleUpdate(FeedShard& shard, const Message& msg);
+		void handleUpdate(FeedShard& shard, const Wire::FrameView& frame);
+		void printQueriedQuote(const QuoteTick& tick);
+		void restoreCachedSnapshot();
+		void addTopicFilter(FeedShard& shard, const std::string& symbol);
+		void removeTopicFilter(FeedShard& shard, const std::string& symbol);
 		bool isStockSubscribed(const std::string& symbol);
 
 		// UI rendering
-		void renderStockList();
-		void renderFullGraph(const std::string& symbol);
+		void renderFullGraph(const std::string& symbol, size_t points, bool braille, std::optional<int64_t> span_ns);
+		void renderStats(const std::string& symbol);
+		void composeDashboard(FrameBuffer& frame);
 
 		// Command handlers
-		void subscribe(const std::string& symbol);
-		void unsubscribe(const std::string& symbol);
-		void query(const std::string& symbol);
-		void requestPriceHistory(const std::string& symbol);
-		void listStocks();
+		void subscribe(const std::vector<std::string>& symbols);
+		void unsubscribe(const std::vector<std::string>& symbols);
+		void query(const std::vector<std::string>& symbols);
+		void requestPriceHistory(const std::vector<std::string>& symbols, bool shown = true); // false for resyncs
+		void showHistory(const std::vector<std::string>& symbols, std::optional<int64_t> span_ns);
+		void sendRequests(const std::vector<Message>& requests, std::optional<uint32_t> shard = std::nullopt);
+		size_t requestFanout(const std::string& symbol) const; // Services a request for `symbol` reaches
+		void listStocks(const std::vector<std::string>& options, RankKey default_key, size_t default_count);
+		void watchStocks();
 		void showHelp();
 		void clearScreen();
 		
 
-		void updateStockData(const StockQuote& quote);
+		bool updateStockData(FeedShard& shard, const QuoteTick& tick);
 
 		// Safety methods
 		bool confirmAction(const std::string& action, const std::string& symbol);
 		bool isValidSymbolFormat(const std::string& symbol);
 
 		void setCurrency(const std::string& currency);
-		void displayPriceInCurrency(double price) const;
 
+		CliApp(const CliConfig& config, std::unique_ptr<zmq::context_t> owned, zmq::context_t* shared);
 
 
 	public:
-		CliApp();
+		explicit CliApp(const CliConfig& config = {});
+		// Shares `context` with the caller, so inproc:// endpoints in the config reach it.
+		CliApp(const CliConfig& config, zmq::context_t& context);
+		~CliApp();
 		void printWelcomeMessage();
 		void showUsageCosts();
 		void showSafetyTips();
-		void run();
+		void run();   // Interactive: start(), then reads commands until 'exit'
+		// Non-interactive: sends every command in `input` without waiting for replies, prints
+		// one result line per request, and returns once all are answered or the deadline
+		// passes. Returns the exit code, 0 if every request succeeded.
+		int runBatch(std::istream& input);
+		void start(); // Headless: only the shard workers and presenter thread
 		void stop();
+		void setTickObserver(std::function<void(const QuoteTick&)> observer);
 
 		CliApp(const CliApp&) = delete;
 		CliApp& operator=(const CliApp&) = delete;
@@ -0,0 +1,44 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+
+
+namespace StockTracker {
+
+	// Runtime options for the CLI, parsed from the command line in main().
+	struct CliConfig {
+		size_t history_depth{ 2048 }; // Ticks kept in memory per symbol
+		size_t watch_fps{ 20 };       // Frame rate cap for the 'watch' dashboard
+		size_t print_interval_ms{ 100 }; // How often coalesced updates are printed at the prompt
+		bool topic_filtering{ false };   // Subscribe per symbol topic; needs a publisher that sends topics
+		size_t connect_attempts{ 10 };   // RequestSubscriptions retries before giving up on the DataService
+		std::string cache_path{ "tickrshell_cache.json" }; // Startup snapshot; empty disables it
+		size_t fx_ttl_s{ 300 }; // How long an FX rate is used before it is fetched again
+		std::string tick_dir{ "ticks" }; // Local tick files for 'history' and 'graph'; empty disables them
+		size_t tick_retention_h{ 168 };  // Hours of ticks kept per symbol; 0 keeps everything
+		// Bound; DataServices read requests here. Either one shared by every feed's service,
+		// or one per feed endpoint in the same order, so requests reach only their owner.
+		std::vector<std::string> request_endpoints{ "tcp://*:5557" };
+		// Connected; quotes and replies arrive here. Each endpoint is a DataService publishing
+		// its own symbols, ingested by its own worker thread.
+		std::vector<std::string> feed_endpoints{ "tcp://localhost:5556" };
+		bool pin_workers{ false }; // Pin each feed's worker thread to its own core
+		size_t receive_hwm{ 1000 }; // Feed messages ZMQ queues before dropping, 0 for no limit; gaps are resynced
+		std::string metrics_file; // Pipeline metrics are appended here as JSON lines; empty disables it
+		size_t metrics_interval_s{ 10 };
+		size_t corr_interval_ms{ 1000 }; // Prices are sampled for 'corr' and 'beta' once per interval
+		size_t corr_window{ 120 };       // Returns per symbol 'corr' and 'beta' are computed over
+
+		// Non-interactive runs: commands come from stdin (--batch) or a file (--script),
+		// are sent without waiting for replies, and each result is printed as one line.
+		bool batch{ false };
+		std::string script_path; // Empty reads stdin
+		bool batch_json{ false }; // JSON lines instead of CSV
+		size_t batch_deadline_s{ 30 }; // Replies still outstanding after this are reported as timed out
+
+		// Throws std::invalid_argument on unknown options or bad values.
+		static CliConfig fromArgs(int argc, char* argv[]);
+		static void printUsage(const std::string& program);
+	};
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include "FlatSymbolMap.h"
+#include "QuoteStore.h"
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+namespace StockTracker {
+
+	// Everything that happened to one symbol since the presenter last looked.
+	struct ConflatedQuote {
+		std::string symbol;
+		StockData latest;
+		uint64_t ticks{ 0 };  // Quotes folded into this entry
+		double high{ 0.0 };   // Price range over those quotes
+		double low{ 0.0 };
+		int64_t received_ns{ 0 }; // monotonicNs() when the latest quote was received
+	};
+
+	// Coalesces quote bursts between the update thread and the presenter.
+	// push() keeps only the newest quote per symbol plus counters, so a burst of
+	// ticks costs one flat-table probe each and the presenter sees one entry per symbol
+	// however fast the feed runs. The lock is held for a few field writes on push
+	// and a vector swap on drain.
+	class Conflator {
+	public:
+		void push(SymbolKey symbol, const StockData& data, int64_t received_ns);
+
+		// Replaces `batch` with the pending entries, in first-seen order. Reusing the
+		// same vector lets the two buffers trade storage instead of allocating.
+		void drain(std::vector<ConflatedQuote>& batch);
+
+		size_t pending() const;
+
+	private:
+		mutable std::mutex mutex;
+		std::vector<ConflatedQuote> entries;
+		FlatSymbolMap<size_t> index; // Symbol -> position in entries
+	};
+}
@@ -0,0 +1,112 @@
+#pragma once
+#include "FlatSymbolMap.h"
+#include "QuoteStore.h"
+#include "TickHistory.h"
+#include "VectorKernels.h"
+#include "WorkerPool.h"
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+namespace StockTracker {
+
+	// Pairwise correlation and beta of recent returns across every subscribed symbol.
+	//
+	// Prices are sampled on one clock, once per bucket of wall time, so all symbols'
+	// returns line up in time. A symbol's last `window` log returns are one padded row of
+	// a contiguous matrix, and bucket k is stored in column k % window of every row; sums
+	// and dot products don't depend on order, so the ring is never unrolled. Each new
+	// bucket updates the per-symbol sums and the Gram matrix of dot products by adding
+	// the new column and removing the one it replaces, O(n^2) for n symbols. When the
+	// symbols change, and every `window` buckets so rounding error can't build up, the
+	// rows are backfilled from the tick history and the Gram matrix is rebuilt with
+	// vectorised dot products, blocks of rows spread over a pool of threads that is
+	// started by the first rebuild and kept for the next.
+	// Sampled by the presenter thread; the lock is held for a sample and for a read.
+	class CorrelationMatrix {
+	public:
+		struct Pair {
+			SymbolKey a{ NO_SYMBOL };
+			SymbolKey b{ NO_SYMBOL };
+			double correlation{ 0.0 };
+		};
+
+		// `threads` 0 rebuilds on every core. With `first_core` the rebuild threads other
+		// than the caller are pinned to consecutive cores from there.
+		CorrelationMatrix(const QuoteStore& stocks, int64_t bucket_ns, size_t window,
+			const VectorKernels& kernels = VectorKernels::simd(), size_t threads = 0,
+			std::optional<size_t> first_core = std::nullopt);
+
+		// Samples every subscribed symbol if a new bucket has started since the last call.
+		void advance(int64_t now_ns);
+
+		// Empty if either symbol isn't sampled yet or hasn't moved in the window.
+		std::optional<double> correlation(SymbolKey a, SymbolKey b) const;
+		std::optional<double> beta(SymbolKey symbol, SymbolKey index) const;
+
+		// Replaces `out` with the `count` pairs of largest |correlation|, strongest first,
+		// only those including `symbol` unless it is NO_SYMBOL.
+		void strongest(size_t count, SymbolKey symbol, std::vector<Pair>& out) const;
+
+		size_t size() const;
+		size_t window() const { return length; }
+		int64_t bucketNs() const { return bucket_ns; }
+
+		// The upper triangle (j >= i) of the dot products of `count` rows of `stride`
+		// doubles, into `out` as count x count. Blocks of rows are spread over `pool`, or
+		// all done by the caller if it is null.
+		static void gram(const double* rows, size_t count, size_t stride, double* out,
+			const VectorKernels& kernels, WorkerPool* pool);
+
+		CorrelationMatrix(const CorrelationMatrix&) = delete;
+		CorrelationMatrix& operator=(const CorrelationMatrix&) = delete;
+
+	private:
+		static constexpr size_t ROW_BLOCK = 16; // Rows sharing one pass over the others in gram()
+		static constexpr double MIN_VARIANCE = 1e-18; // Per bucket; below this a symbol hasn't moved
+		static constexpr int64_t NO_BUCKET = std::numeric_limits<int64_t>::min();
+
+		using Prices = std::vector<std::pair<std::string, StockData>>;
+
+		bool sameSymbols(const Prices& prices) const;
+		void reindex(const Prices& prices, int64_t bucket);
+		void backfill(size_t row, const std::string& symbol, double current_price, int64_t bucket);
+		void rebuild();
+		void addColumn(const std::vector<double>& added, const std::vector<double>& removed);
+		size_t slotOf(int64_t bucket) const;
+		std::optional<double> correlationAt(size_t i, size_t j) const;
+		double cross(size_t i, size_t j) const; // n * sum(x_i x_j) - sum(x_i) sum(x_j)
+
+		const QuoteStore& stocks;
+		const int64_t bucket_ns;
+		const size_t length;  // Returns per symbol
+		const size_t stride;  // Row length, padded to a multiple of 4 doubles
+		const VectorKernels& kernels;
+		const size_t threads;
+		const std::optional<size_t> first_core;
+		std::unique_ptr<WorkerPool> pool; // Started by the first rebuild with more than one block
+
+		mutable std::mutex mutex;
+		int64_t last_bucket{ NO_BUCKET };
+		size_t since_rebuild{ 0 }; // Buckets added incrementally since the last rebuild
+		std::vector<SymbolKey> keys;   // Row -> symbol
+		FlatSymbolMap<size_t> rows_by_symbol;
+		std::vector<double> returns;   // keys.size() rows of `stride`
+		std::vector<double> last_prices;
+		std::vector<double> sums;
+		std::vector<double> products;  // Gram matrix, upper triangle
+
+		// Sampling scratch
+		std::vector<double> added;
+		std::vector<double> removed;
+		std::vector<double> latest;
+		TickSeries series;
+	};
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+
+namespace StockTracker {
+
+	using CurrencyId = uint8_t;
+
+	// Process-wide table of currency codes. A code is interned once and then handled as a
+	// small integer, so hot paths index arrays instead of comparing strings.
+	// Lookups are lock-free; new codes are appended under a mutex and never removed.
+	namespace Currencies {
+		constexpr size_t MAX = 64;
+		constexpr CurrencyId USD = 0;
+		constexpr CurrencyId EUR = 1;
+		constexpr CurrencyId GBP = 2;
+		constexpr CurrencyId JPY = 3;
+		constexpr CurrencyId UNKNOWN = MAX - 1; // "XXX", also used once the table is full
+
+		CurrencyId intern(std::string_view code);
+		std::string_view code(CurrencyId id);
+		std::string_view prefix(CurrencyId id); // Printed before an amount: "$", or "CHF "
+		size_t count();
+	}
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+
+namespace StockTracker {
+
+	// Grid of single-byte cells holding one composed frame.
+	class FrameBuffer {
+	public:
+		FrameBuffer(size_t width, size_t height);
+
+		void clear();
+		void put(size_t row, size_t col, std::string_view text); // Clipped to the grid
+
+		const char* row(size_t r) const { return cells.data() + r * columns; }
+		size_t width() const { return columns; }
+		size_t height() const { return rows; }
+
+	private:
+		size_t columns;
+		size_t rows;
+		std::string cells;
+	};
+
+	// Double-buffered terminal renderer for the 'watch' view.
+	// Frames are composed off-screen in the back buffer and compared with the front
+	// buffer, which mirrors what the terminal shows. Only the changed runs are emitted,
+	// using ANSI cursor moves, and the whole frame goes out in a single write.
+	class Dashboard {
+	public:
+		Dashboard(size_t width, size_t height);
+
+		// Back buffer for the next frame, cleared after every present().
+		FrameBuffer& frame() { return back; }
+
+		// Switches to the alternate screen and hides the cursor; leave() restores both.
+		void enter();
+		void leave();
+
+		// Writes the difference between the composed frame and the screen. Returns bytes written.
+		size_t present();
+
+	private:
+		// Unchanged cells between two changed runs that are cheaper to rewrite than to skip
+		static constexpr size_t MERGE_GAP = 8;
+
+		void moveTo(size_t row, size_t col);
+
+		FrameBuffer front;
+		FrameBuffer back;
+		std::string output;      // Reused frame output buffer
+		bool full_redraw{ true };
+	};
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include "AlertBook.h"
+#include "Conflator.h"
+#include "FlatSymbolMap.h"
+#include "Metrics.h"
+#include "RankIndex.h"
+#include "SequenceTracker.h"
+#include "TickStore.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+#include <zmq.hpp>
+
+
+namespace StockTracker {
+
+	// A symbol whose lost ticks have been requested again as history.
+	struct PendingResync {
+		int64_t from_ns;      // Last tick before the first gap
+		int64_t to_ns;        // First tick after the latest gap
+		uint64_t missed;
+		int64_t requested_ns; // monotonicNs() of the last request
+	};
+
+	// One feed endpoint and the worker thread that ingests it.
+	//
+	// Each DataService instance publishes a disjoint range of symbols, so a shard's worker
+	// is the only writer of its symbols' state: it claims them in the QuoteStore, and owns
+	// everything marked worker-only below outright. What the presenter and input threads
+	// read (conflated quotes, rankings, metrics) is kept per shard too, each behind its
+	// own short lock or single-writer atomics, and merged by the reader.
+	struct FeedShard {
+		FeedShard(zmq::context_t& context, uint32_t index, const std::string& endpoint, size_t receive_hwm,
+			const std::string& control_topic, TickStore* tick_store);
+
+		// Queues `task` for the worker and wakes it. Any thread.
+		void post(std::function<void(FeedShard&)> task);
+		void wake();
+		void runTasks(); // Worker only
+
+		const uint32_t index; // Writer id for the QuoteStore claim
+		const std::string endpoint;
+
+		// The worker polls the subscriber together with an inproc wakeup pair, so it
+		// sleeps until there is work and stop() interrupts it immediately.
+		zmq::socket_t subscriber;
+		zmq::socket_t wakeup_receiver; // Worker side
+		std::thread worker;
+
+		// Worker only.
+		bool handshake_done{ false };
+		bool subscriptions_listed{ false }; // A SubscriptionsList has arrived, possibly after giving up
+		size_t handshake_attempts{ 0 };
+		std::chrono::milliseconds handshake_retry{ 0 };
+		std::chrono::steady_clock::time_point next_handshake{};
+		std::unordered_set<std::string> topic_filters; // Per-symbol filters set on the subscriber
+		SequenceTracker sequences;
+		FlatSymbolMap<PendingResync> resyncs;
+		std::vector<std::string> resync_requests;
+		AlertBook alerts;
+		std::vector<FiredAlert> fired_alerts;
+		std::vector<Alert> alert_rows;
+		std::unique_ptr<TickStore::Writer> tick_writer; // Null without a tick store
+		int64_t message_received_ns{ 0 }; // monotonicNs() when the current message arrived
+
+		// Written by the worker, read by the presenter and input threads.
+		Conflator conflator;
+		RankIndex rankings;
+		PipelineMetrics metrics; // Ingest stages only
+
+		FeedShard(const FeedShard&) = delete;
+		FeedShard& operator=(const FeedShard&) = delete;
+
+	private:
+		std::mutex task_mutex; // Also serialises use of wakeup_sender
+		std::vector<std::function<void(FeedShard&)>> tasks;
+		zmq::socket_t wakeup_sender;
+	};
+}
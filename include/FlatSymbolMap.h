@@ -0,0 +1,147 @@
+#pragma once
+#include "Symbol.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+namespace StockTracker {
+
+	// Open-addressing hash table keyed by SymbolKey, with linear probing and a
+	// power-of-two capacity kept at most half full. Keys and values sit inline in one
+	// array, so a lookup is a multiply, a shift and usually a single cache line.
+	// Erase shifts later entries back instead of leaving tombstones. NO_SYMBOL marks an
+	// empty entry, so it is never a key: it is not found, inserted or erased.
+	// Not thread-safe; QuoteStore publishes immutable copies of it.
+	template <typename V>
+	class FlatSymbolMap {
+	public:
+		explicit FlatSymbolMap(size_t expected = 0) {
+			size_t capacity = MIN_CAPACITY;
+			while (capacity < expected * 2) {
+				capacity *= 2;
+			}
+			resize(capacity);
+		}
+
+		V* find(SymbolKey key) {
+			return const_cast<V*>(static_cast<const FlatSymbolMap&>(*this).find(key));
+		}
+
+		const V* find(SymbolKey key) const {
+			if (key == NO_SYMBOL) {
+				return nullptr;
+			}
+			for (size_t i = home(key);; i = (i + 1) & mask) {
+				if (entries[i].key == key) {
+					return &entries[i].value;
+				}
+				if (entries[i].key == NO_SYMBOL) {
+					return nullptr;
+				}
+			}
+		}
+
+		// Returns false, leaving the map unchanged, if the key is already present or NO_SYMBOL.
+		bool insert(SymbolKey key, const V& value) {
+			if (key == NO_SYMBOL) {
+				return false;
+			}
+			if ((count + 1) * 2 > entries.size()) {
+				rehash(entries.size() * 2);
+			}
+			size_t i = home(key);
+			for (; entries[i].key != NO_SYMBOL; i = (i + 1) & mask) {
+				if (entries[i].key == key) {
+					return false;
+				}
+			}
+			entries[i] = { key, value };
+			++count;
+			return true;
+		}
+
+		bool erase(SymbolKey key) {
+			if (key == NO_SYMBOL) {
+				return false;
+			}
+			size_t hole = home(key);
+			for (; entries[hole].key != key; hole = (hole + 1) & mask) {
+				if (entries[hole].key == NO_SYMBOL) {
+					return false;
+				}
+			}
+
+			// Move back any later entry in the run whose home is not between the hole and itself
+			for (size_t i = (hole + 1) & mask; entries[i].key != NO_SYMBOL; i = (i + 1) & mask) {
+				const size_t wanted = home(entries[i].key);
+				if (((i - wanted) & mask) >= ((i - hole) & mask)) {
+					entries[hole] = entries[i];
+					hole = i;
+				}
+			}
+			entries[hole] = Entry{};
+			--count;
+			return true;
+		}
+
+		void clear() {
+			for (auto& entry : entries) {
+				entry = Entry{};
+			}
+			count = 0;
+		}
+
+		size_t size() const { return count; }
+		bool empty() const { return count == 0; }
+
+		// Calls visit(key, value) for every entry, in table order.
+		template <typename Visit>
+		void forEach(Visit&& visit) const {
+			for (const auto& entry : entries) {
+				if (entry.key != NO_SYMBOL) {
+					visit(entry.key, entry.value);
+				}
+			}
+		}
+
+	private:
+		static constexpr size_t MIN_CAPACITY = 16;
+
+		struct Entry {
+			SymbolKey key{ NO_SYMBOL };
+			V value{};
+		};
+
+		// Fibonacci hashing: the multiply mixes every character into the top bits
+		size_t home(SymbolKey key) const {
+			return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> shift);
+		}
+
+		void resize(size_t capacity) {
+			entries.assign(capacity, Entry{});
+			mask = capacity - 1;
+			shift = 64;
+			for (size_t c = capacity; c > 1; c >>= 1) {
+				--shift;
+			}
+		}
+
+		void rehash(size_t capacity) {
+			std::vector<Entry> old;
+			old.swap(entries);
+			resize(capacity);
+			count = 0;
+			for (const auto& entry : old) {
+				if (entry.key != NO_SYMBOL) {
+					insert(entry.key, entry.value);
+				}
+			}
+		}
+
+		std::vector<Entry> entries;
+		size_t count{ 0 };
+		size_t mask{ 0 };
+		unsigned shift{ 64 };
+	};
+}
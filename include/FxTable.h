@@ -0,0 +1,49 @@
+#pragma once
+#include "Currency.h"
+#include <StockTracker/CurrencyService.h>
+#include <array>
+#include <bitset>
+#include <chrono>
+#include <mutex>
+
+
+namespace StockTracker {
+
+	// Conversion from every interned currency into one display currency, valid for one render.
+	struct FxFactors {
+		CurrencyId target{ Currencies::USD };
+		std::array<double, Currencies::MAX> factor;      // Multiply an amount in currency i by factor[i]
+		std::array<CurrencyId, Currencies::MAX> display; // Currency the converted amount is in
+
+		FxFactors();
+
+		double operator()(double amount, CurrencyId from) const { return amount * factor[from]; }
+	};
+
+	using CurrencySet = std::bitset<Currencies::MAX>;
+
+	// USD-based FX rates fetched through CurrencyService, each cached for `ttl`.
+	// prepare() refreshes the stale rates a render needs up front, which is the only place the service is
+	// called or can throw, so rendering afterwards is plain arithmetic. A rate that can't
+	// be fetched keeps its last value; amounts in a currency that has never had one are
+	// shown unconverted. Thread-safe.
+	class FxTable {
+	public:
+		FxTable(CurrencyService& service, std::chrono::seconds ttl);
+
+		// `sources` are the currencies the amounts about to be converted are in.
+		FxFactors prepare(CurrencyId target, const CurrencySet& sources);
+
+	private:
+		using Clock = std::chrono::steady_clock;
+
+		void refresh(CurrencyId id, Clock::time_point now);
+
+		CurrencyService& service;
+		std::chrono::seconds ttl;
+
+		std::mutex mutex;
+		std::array<double, Currencies::MAX> usd_rates{};          // Units per USD, 0 if never fetched
+		std::array<Clock::time_point, Currencies::MAX> expires{}; // Failed fetches also wait a TTL
+	};
+}
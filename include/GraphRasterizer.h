@@ -0,0 +1,41 @@
+#pragma once
+#include "TickHistory.h"
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+
+namespace StockTracker {
+
+	struct GraphBounds {
+		double min{ 0.0 };
+		double max{ 0.0 };
+	};
+
+	struct GraphOptions {
+		size_t width{ 80 };   // Terminal columns, including the price axis
+		size_t height{ 10 };  // Text rows of plot area
+		bool braille{ false }; // 2x4 dots per cell instead of one '*'
+		std::optional<GraphBounds> bounds; // Price range; derived from the samples if not given
+	};
+
+	// Renders a price series to a text frame in one pass over the samples.
+	// Samples are downsampled to the plot width by keeping the min and max of each
+	// column's bucket, so spikes survive however many points there are. Each column
+	// is drawn as a vertical run between those two values. All buffers are reused
+	// between calls, and the frame is returned as one string for a single write.
+	class GraphRasterizer {
+	public:
+		const std::string& render(Span<double> prices, const GraphOptions& options);
+
+	private:
+		static constexpr size_t AXIS_WIDTH = 11; // "%8.2f | " price labels
+
+		std::vector<double> column_min;
+		std::vector<double> column_max;
+		std::vector<uint8_t> grid; // Braille dot bits, or 1 for '*', one byte per text cell
+		std::string output;
+	};
+}
@@ -0,0 +1,109 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+
+namespace StockTracker {
+
+	// Monotonic nanoseconds, for measuring intervals inside this process.
+	inline int64_t monotonicNs() {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	// Each metric has one writer thread, so updates are a relaxed load and store rather
+	// than a locked read-modify-write. Any thread may read them at any time. Threads
+	// doing the same work keep their own metrics, merged into a fresh copy for display.
+	class Counter {
+	public:
+		void add(uint64_t n = 1) { value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed); }
+		uint64_t load() const { return value.load(std::memory_order_relaxed); }
+
+	private:
+		std::atomic<uint64_t> value{ 0 };
+	};
+
+	// Last and largest value of a queue depth or batch size.
+	class Gauge {
+	public:
+		void set(uint64_t v) {
+			last.store(v, std::memory_order_relaxed);
+			if (v > peak.load(std::memory_order_relaxed)) {
+				peak.store(v, std::memory_order_relaxed);
+			}
+		}
+		uint64_t current() const { return last.load(std::memory_order_relaxed); }
+		uint64_t max() const { return peak.load(std::memory_order_relaxed); }
+		void merge(const Gauge& other); // Sums the current values, keeps the larger peak
+
+	private:
+		std::atomic<uint64_t> last{ 0 };
+		std::atomic<uint64_t> peak{ 0 };
+	};
+
+	// Log-linear latency histogram in the style of HdrHistogram: every power of two is
+	// split into SUB_BUCKETS linear buckets, so any recorded value is within ~3% of its
+	// bucket and the whole range from 1 ns to ~18 minutes fits in a fixed array.
+	// record() is a few shifts and two stores, with no allocation.
+	class LatencyHistogram {
+	public:
+		struct Summary {
+			uint64_t count{ 0 };
+			double mean_ns{ 0.0 };
+			int64_t p50_ns{ 0 };
+			int64_t p90_ns{ 0 };
+			int64_t p99_ns{ 0 };
+			int64_t p999_ns{ 0 };
+			int64_t max_ns{ 0 };
+		};
+
+		void record(int64_t ns);
+		void merge(const LatencyHistogram& other); // Into a copy this thread writes
+		Summary summary() const; // Consistent enough for display while the writer runs
+
+	private:
+		static constexpr unsigned SUB_BUCKET_BITS = 5;
+		static constexpr uint64_t SUB_BUCKETS = uint64_t{ 1 } << SUB_BUCKET_BITS;
+		static constexpr unsigned MAX_VALUE_BITS = 40;
+		static constexpr size_t BUCKETS = SUB_BUCKETS * (MAX_VALUE_BITS - SUB_BUCKET_BITS + 1);
+
+		static size_t bucketOf(uint64_t value);
+		static uint64_t bucketValue(size_t bucket); // Highest value that lands in the bucket
+
+		std::array<std::atomic<uint64_t>, BUCKETS> counts{};
+		std::atomic<uint64_t> sum_ns{ 0 };
+		std::atomic<uint64_t> max_ns{ 0 };
+	};
+
+	// Where a quote's time goes on its way from the feed to the screen, plus message
+	// counters and queue depths. Shown by the 'metrics' command and optionally appended
+	// to a file as one JSON object per line.
+	struct PipelineMetrics {
+		// Update thread
+		LatencyHistogram feed_age; // Quote timestamp to receive; across machines this includes clock skew
+		LatencyHistogram decode;   // Receive to decoded message
+		LatencyHistogram apply;    // One tick through updateStockData
+		Counter messages;          // Feed messages received
+		Counter quotes;            // Ticks applied to subscribed symbols
+		Counter malformed;         // Messages dropped because they couldn't be decoded
+		Gauge drain_batch;         // Messages handled per wakeup
+		Counter gaps;              // Sequence gaps detected
+		Counter missed;            // Ticks lost in those gaps
+		Counter stale;             // Duplicate or out-of-order ticks dropped
+		Counter resyncs;           // History requests sent to fill gaps
+		Counter recovered;         // Missed ticks found in the resync replies
+
+		// Presenter thread
+		LatencyHistogram staleness; // Receive to printed or drawn, per symbol shown
+		LatencyHistogram render;    // One printed batch or dashboard frame
+		Gauge conflated;            // Symbols waiting per presenter interval
+
+		void merge(const PipelineMetrics& other);
+		void writeReport(std::ostream& out) const;
+		void writeJson(std::ostream& out) const; // One line, no trailing newline
+	};
+}
@@ -0,0 +1,112 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+
+namespace spdlog {
+	class logger;
+}
+
+namespace StockTracker {
+
+	// All terminal output goes through here, so no thread that matters ever waits on a
+	// slow terminal or pipe. Any thread may push text; a dedicated writer thread gathers
+	// whatever is queued into one write and one flush.
+	//
+	// The queue is a bounded lock-free MPSC ring (Vyukov's sequence-per-cell scheme). A
+	// push into a full ring is dropped and counted instead of waiting, and the writer
+	// reports the drop in the output. The writer only sleeps when the ring is empty;
+	// producers take the mutex to wake it only then.
+	class OutputQueue {
+	public:
+		// One piece of output, formatted like any ostream and queued as a whole when it
+		// goes out of scope. A Line with no queue discards its text.
+		class Line : public std::ostringstream {
+		public:
+			explicit Line(OutputQueue* queue) : queue(queue) {}
+			~Line() override;
+
+			Line(const Line&) = delete;
+			Line& operator=(const Line&) = delete;
+
+		private:
+			OutputQueue* queue;
+		};
+
+		explicit OutputQueue(std::ostream& sink, size_t capacity = 4096);
+		~OutputQueue(); // Writes everything still queued
+
+		// Never blocks. Returns false, and counts a drop, if the ring is full.
+		bool push(std::string text);
+		// Waits for room instead, for output that must not be lost (batch results).
+		void pushWaiting(std::string text);
+		Line line() { return Line(this); }
+
+		// Blocks until everything pushed so far has been written.
+		void waitUntilWritten() const;
+
+		// pause() returns once the writer has finished its current write, and nothing more
+		// is written until resume(), so the caller can own the terminal (the 'watch'
+		// dashboard) without other threads' output landing in its frames. Pushes queue up
+		// meanwhile, and are dropped once the ring is full; don't pushWaiting while paused.
+		void pause();
+		void resume();
+
+		uint64_t dropped() const { return drops.load(std::memory_order_relaxed); }
+		size_t pending() const;
+
+		OutputQueue(const OutputQueue&) = delete;
+		OutputQueue& operator=(const OutputQueue&) = delete;
+
+	private:
+		static constexpr size_t MAX_WRITE_BYTES = 64 * 1024; // Per write; the rest waits for the next one
+
+		struct Cell {
+			std::atomic<size_t> sequence{ 0 };
+			std::string text;
+		};
+
+		bool enqueue(std::string& text); // Moves from `text` only on success
+		bool pop(std::string& out); // Writer only, appends to `out`
+		void writeLoop();
+
+		std::ostream& sink;
+		std::unique_ptr<Cell[]> cells;
+		size_t mask;
+
+		alignas(64) std::atomic<size_t> enqueue_position{ 0 };
+		alignas(64) size_t dequeue_position{ 0 }; // Writer only
+		std::atomic<size_t> written{ 0 };         // Cells written so far, for waitUntilWritten
+		std::atomic<uint64_t> drops{ 0 };
+
+		std::mutex sink_mutex; // Held by the writer while it pops and writes
+		std::mutex wake_mutex;
+		std::condition_variable wake;
+		std::atomic<bool> writer_idle{ false };
+		std::atomic<bool> paused{ false };
+		std::atomic<bool> stopping{ false };
+		std::thread writer;
+	};
+
+	// Sends spdlog's default logger through `queue` for the guard's lifetime, then puts
+	// the previous logger back.
+	class LogRoute {
+	public:
+		explicit LogRoute(OutputQueue& queue);
+		~LogRoute();
+
+		LogRoute(const LogRoute&) = delete;
+		LogRoute& operator=(const LogRoute&) = delete;
+
+	private:
+		std::shared_ptr<spdlog::logger> previous;
+	};
+}
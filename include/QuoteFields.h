@@ -0,0 +1,100 @@
+#pragma once
+#include "Symbol.h"
+#include <StockTracker/Messages.h>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+
+namespace StockTracker {
+
+	// Accessors for StockQuote fields that the CLI stores in fixed-width columns.
+	// Keeping them in one place means a change to the shared message format only
+	// touches this header.
+
+	inline int64_t quoteTimestampNs(const StockQuote& quote) {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(quote.timestamp.time_since_epoch()).count();
+	}
+
+	namespace detail {
+		template <typename Q, typename = void>
+		struct HasVolume : std::false_type {};
+
+		template <typename Q>
+		struct HasVolume<Q, std::void_t<decltype(std::declval<const Q&>().volume)>> : std::true_type {};
+
+		template <typename T>
+		double toVolume(const std::optional<T>& volume) { return volume ? static_cast<double>(*volume) : 0.0; }
+
+		template <typename T>
+		double toVolume(const T& volume) { return static_cast<double>(volume); }
+
+		template <typename Q, typename = void>
+		struct HasSequence : std::false_type {};
+
+		template <typename Q>
+		struct HasSequence<Q, std::void_t<decltype(std::declval<const Q&>().sequence)>> : std::true_type {};
+
+		template <typename T>
+		uint64_t toSequence(const std::optional<T>& sequence) { return sequence ? static_cast<uint64_t>(*sequence) : 0; }
+
+		template <typename T>
+		uint64_t toSequence(const T& sequence) { return static_cast<uint64_t>(sequence); }
+	}
+
+	// Traded volume for the tick, or 0 when the feed does not report volume.
+	template <typename Q = StockQuote>
+	double quoteVolume(const Q& quote) {
+		if constexpr (detail::HasVolume<Q>::value) {
+			return detail::toVolume(quote.volume);
+		}
+		else {
+			return 0.0;
+		}
+	}
+
+	// Per-symbol sequence number of the quote, or 0 when the feed does not number them.
+	template <typename Q = StockQuote>
+	uint64_t quoteSequence(const Q& quote) {
+		if constexpr (detail::HasSequence<Q>::value) {
+			return detail::toSequence(quote.sequence);
+		}
+		else {
+			return 0;
+		}
+	}
+
+	// One quote as the CLI consumes it, independent of whether it arrived as JSON or
+	// as a binary frame. The string views borrow from the source message; `key` is the
+	// packed symbol, filled in here at the decode boundary.
+	struct QuoteTick {
+		std::string_view symbol;
+		SymbolKey key{ NO_SYMBOL };
+		std::string_view currency;
+		int64_t timestamp_ns{ 0 };
+		double price{ 0.0 };
+		double change_percent{ 0.0 };
+		double volume{ 0.0 };
+		uint64_t sequence{ 0 }; // Per symbol, counting up from 1; 0 if unnumbered
+	};
+
+	inline QuoteTick toTick(const StockQuote& quote) {
+		QuoteTick tick;
+		tick.symbol = quote.symbol;
+		tick.key = symbolKey(quote.symbol);
+		tick.currency = quote.currency;
+		tick.timestamp_ns = quoteTimestampNs(quote);
+		tick.price = quote.price;
+		tick.change_percent = quote.change_percent.value_or(0.0);
+		tick.volume = quoteVolume(quote);
+		tick.sequence = quoteSequence(quote);
+		return tick;
+	}
+
+	inline const QuoteTick& toTick(const QuoteTick& tick) {
+		return tick;
+	}
+}
@@ -0,0 +1,165 @@
+#pragma once
+#include "Currency.h"
+#include "FlatSymbolMap.h"
+#include "QuoteFields.h"
+#include "RollingStats.h"
+#include "SeqLock.h"
+#include "TickHistory.h"
+#include <StockTracker/Messages.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <deque>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+
+namespace StockTracker {
+
+	// Latest known state for one symbol. Kept trivially copyable so a whole
+	// snapshot can be published through a SeqLock. Price history lives in the
+	// symbol's TickHistory.
+	struct StockData {
+		double current_price{ 0.0 };
+		double change_percent{ 0.0 };
+		CurrencyId currency{ Currencies::USD };
+
+		std::string_view currencyCode() const { return Currencies::code(currency); }
+		void setCurrency(std::string_view code) { currency = Currencies::intern(code); }
+	};
+
+	// Concurrent per-symbol quote store shared by the ingest and input threads.
+	//
+	// Per-symbol data has a single writer. With several ingest threads, each symbol is
+	// claimed by the first one to write it, with one compare-and-swap on its slot, and
+	// the others' writes to it are refused. Quotes and rolling analytics are published
+	// through SeqLocks and history through a TickHistory ring, so readers copy out
+	// consistent snapshots without ever blocking the writer.
+	// The symbol directory is copy-on-write: add/erase build a new map under
+	// writer_mutex and publish it with one atomic pointer swap. It is a flat table keyed
+	// by packed SymbolKeys, so a lookup is a reader-count increment on the thread's own
+	// stripe, an acquire load and an integer probe. A replaced directory is freed as soon
+	// as no reader can still hold it (see ReadGuard). Slots are kept alive until the
+	// store is destroyed; an erased slot is reused if its symbol is added again, so
+	// repeated subscribe/unsubscribe does not grow memory.
+	class QuoteStore {
+	public:
+		explicit QuoteStore(size_t history_depth);
+		~QuoteStore();
+
+		// Directory changes, callable from any thread.
+		bool add(std::string_view symbol);
+		size_t add(const std::vector<std::string>& symbols); // One directory swap for the batch
+		bool erase(std::string_view symbol);
+		size_t erase(const std::vector<std::string>& symbols); // One directory swap for the batch
+
+		// Data updates, from ingest thread `writer`. Empty if the symbol isn't subscribed
+		// or belongs to another writer. `claimed` is set when this call made the claim.
+		std::optional<StockData> apply(const QuoteTick& tick, uint32_t writer, bool& claimed);
+		void restore(std::string_view symbol, const StockData& data); // Adds the symbol, no history tick
+
+		// `history` is any sized range of StockQuote or QuoteTick, oldest first.
+		// Returns false if the symbol can't be stored or belongs to another writer.
+		// `claimed` is set as for apply().
+		template <typename Range>
+		bool replaceHistory(std::string_view symbol, const Range& history, uint32_t writer, bool& claimed) {
+			Slot* slot = resetHistory(symbol, writer, claimed);
+			if (!slot) {
+				return false;
+			}
+			Slot& target = *slot;
+
+			// Only the newest `depth` entries fit; skip the rest instead of appending and overwriting.
+			// Analytics only ever look at the last MAX_STATS_WINDOW ticks.
+			const size_t skip_history = history.size() > history_depth ? history.size() - history_depth : 0;
+			const size_t skip_stats = history.size() > MAX_STATS_WINDOW ? history.size() - MAX_STATS_WINDOW : 0;
+			auto it = history.begin();
+			std::advance(it, std::min(skip_history, skip_stats));
+			for (size_t i = std::min(skip_history, skip_stats); it != history.end(); ++it, ++i) {
+				const QuoteTick& tick = toTick(*it);
+				if (i >= skip_history) {
+					target.history.append(tick.timestamp_ns, tick.price, tick.volume);
+				}
+				if (i >= skip_stats) {
+					target.analytics.add(tick.price, tick.volume);
+				}
+			}
+			target.stats.store(target.analytics.current());
+			return true;
+		}
+
+		// Readers, callable from any thread.
+		std::optional<StockData> find(std::string_view symbol) const;
+		bool contains(std::string_view symbol) const;
+		std::optional<uint32_t> writerOf(std::string_view symbol) const; // Empty until a writer claims it
+		std::optional<SymbolStats> stats(std::string_view symbol) const;
+		size_t copyHistory(std::string_view symbol, TickSeries& out,
+			size_t newest = std::numeric_limits<size_t>::max()) const;
+		std::vector<std::pair<std::string, StockData>> snapshot() const;
+		size_t size() const;
+		bool empty() const;
+
+		QuoteStore(const QuoteStore&) = delete;
+		QuoteStore& operator=(const QuoteStore&) = delete;
+
+	private:
+		struct Slot {
+			explicit Slot(size_t history_depth) : history(history_depth) {}
+
+			SeqLock<StockData> data;
+			TickHistory history;
+			RollingStats analytics; // Writer only, published through `stats`
+			SeqLock<SymbolStats> stats;
+			std::atomic<uint32_t> writer{ NO_WRITER }; // Kept when the slot is retired and reused
+		};
+		using Directory = FlatSymbolMap<Slot*>;
+
+		static constexpr uint32_t NO_WRITER = std::numeric_limits<uint32_t>::max();
+		static bool claim(Slot& slot, uint32_t writer, bool& claimed);
+
+		// Held by a reader for as long as it uses a directory. Readers count themselves in
+		// the current one of two generations; publish() moves new readers to the other
+		// generation and frees the old directory once the previous one has drained. The
+		// counts are striped per thread so ingest threads don't share a cache line.
+		class ReadGuard {
+		public:
+			explicit ReadGuard(const QuoteStore& store);
+			~ReadGuard();
+			const Directory& directory() const { return *current; }
+
+			ReadGuard(const ReadGuard&) = delete;
+			ReadGuard& operator=(const ReadGuard&) = delete;
+
+		private:
+			std::atomic<uint32_t>* count;
+			const Directory* current;
+		};
+		struct alignas(64) ReaderCount {
+			std::atomic<uint32_t> count{ 0 };
+		};
+		static constexpr size_t READER_STRIPES = 16;
+		static size_t readerStripe();
+
+		Slot* findSlot(SymbolKey key) const;
+		Slot* resetHistory(std::string_view symbol, uint32_t writer, bool& claimed); // Null if it can't be stored or claimed
+		void publish(std::unique_ptr<Directory> next);
+
+		std::atomic<const Directory*> directory{ nullptr };
+		mutable std::array<std::array<ReaderCount, READER_STRIPES>, 2> readers;
+		std::atomic<uint32_t> generation{ 0 };
+
+		// Owned by writers, guarded by writer_mutex.
+		std::mutex writer_mutex;
+		size_t history_depth;
+		std::deque<Slot> slots;
+		std::unordered_map<SymbolKey, Slot*> retired; // Erased symbols, reused on re-add
+		std::unique_ptr<const Directory> published;   // What `directory` points to
+	};
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include "FlatSymbolMap.h"
+#include "QuoteStore.h"
+#include <array>
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+
+namespace StockTracker {
+
+	enum class RankKey {
+		Change,  // Signed % change
+		Movers,  // Size of the % change, either direction
+		Price,   // In the quote's own currency
+		Volume,  // Traded this session
+		Symbol,
+	};
+
+	std::optional<RankKey> parseRankKey(std::string_view name);
+	std::string_view rankKeyName(RankKey key);
+
+	// Subscribed symbols kept in order by each RankKey, so 'list' and the dashboard read
+	// one page of a large watchlist instead of sorting all of it every time.
+	//
+	// Each numeric key is a balanced tree of (value, symbol). A quote moves its symbol's
+	// node in each tree in O(log n), re-using the node rather than allocating, and a page
+	// of k rows is read by walking in from whichever end of the tree is nearer. Written by
+	// the update thread; the lock is held for the tree updates on write and the walk on read.
+	class RankIndex {
+	public:
+		struct Row {
+			SymbolKey key{ NO_SYMBOL };
+			StockData data;
+			double volume{ 0.0 };
+		};
+
+		// Adds `volume` to the symbol's session total and re-ranks it.
+		void update(SymbolKey key, const StockData& data, double volume);
+		void erase(SymbolKey key);
+
+		// Replaces `page` with rows [offset, offset + count) in order by `key`.
+		// Ties are broken by symbol key, so paging is stable while prices don't move.
+		void page(RankKey key, bool descending, size_t offset, size_t count, std::vector<Row>& page) const;
+
+		// The same over several indexes holding disjoint symbols, as if they were one. Reads
+		// the first offset + count rows of each and merges them.
+		static void page(const std::vector<const RankIndex*>& indexes, RankKey key, bool descending,
+			size_t offset, size_t count, std::vector<Row>& page);
+
+		size_t size() const;
+		static size_t size(const std::vector<const RankIndex*>& indexes);
+
+	private:
+		static constexpr size_t NUMERIC_KEYS = 4; // RankKey values before Symbol
+
+		struct ByName {
+			bool operator()(SymbolKey a, SymbolKey b) const { return symbolName(a) < symbolName(b); }
+		};
+		using Ranking = std::set<std::pair<double, SymbolKey>>;
+
+		static double rankValue(RankKey key, const Row& row);
+		static bool before(RankKey key, const Row& a, const Row& b); // Ascending order of the trees
+		static void move(Ranking& ranking, SymbolKey key, double from, double to);
+
+		mutable std::mutex mutex;
+		FlatSymbolMap<Row> rows;
+		std::array<Ranking, NUMERIC_KEYS> rankings;
+		std::set<SymbolKey, ByName> by_symbol;
+	};
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+
+namespace StockTracker {
+
+	// Tick-count windows analytics are kept for, shortest first.
+	constexpr std::array<size_t, 3> STATS_WINDOWS{ 20, 60, 240 };
+	constexpr size_t MAX_STATS_WINDOW = STATS_WINDOWS.back();
+
+	struct WindowStats {
+		size_t count{ 0 }; // Ticks in the window, up to its length
+		double sma{ 0.0 };
+		double ema{ 0.0 }; // Smoothing 2 / (length + 1), over every tick seen
+		double stddev{ 0.0 };
+		double min{ 0.0 };
+		double max{ 0.0 };
+	};
+
+	// Everything the 'stats' command and the graph read. Published per symbol
+	// through a SeqLock, so kept trivially copyable.
+	struct SymbolStats {
+		uint64_t ticks{ 0 }; // Since the symbol was added or its history was replaced
+		std::array<WindowStats, STATS_WINDOWS.size()> windows{};
+		double volatility{ 0.0 }; // Stddev of tick-to-tick returns over the longest window
+		double vwap{ 0.0 };       // Over the longest window, 0 when the feed carries no volume
+	};
+
+	// Incremental analytics for one symbol, single writer.
+	// add() is O(1) and allocation free: each window's mean and variance are updated by
+	// adding the new tick and removing the one that leaves it, and min/max come from
+	// monotonic deques. Sums are recomputed from the rings every RESYNC_TICKS ticks so
+	// rounding error can't build up on long-running feeds.
+	class RollingStats {
+	public:
+		void add(double price, double volume);
+		void clear() { *this = RollingStats{}; }
+		const SymbolStats& current() const { return stats; }
+
+	private:
+		static constexpr uint64_t RESYNC_TICKS = 4096;
+
+		// Running mean and sum of squared deviations (Welford), with removal.
+		struct Moments {
+			size_t count{ 0 };
+			double mean{ 0.0 };
+			double m2{ 0.0 };
+
+			void push(double x);
+			void replace(double out, double in);
+			double stddev() const;
+		};
+
+		// Tick indices whose prices are decreasing (minima) or increasing (maxima) from the front.
+		struct MonotonicDeque {
+			std::array<uint64_t, MAX_STATS_WINDOW> ticks{};
+			uint64_t head{ 0 };
+			uint64_t tail{ 0 };
+
+			bool empty() const { return head == tail; }
+			uint64_t front() const { return ticks[head % MAX_STATS_WINDOW]; }
+			uint64_t back() const { return ticks[(tail - 1) % MAX_STATS_WINDOW]; }
+		};
+
+		struct Window {
+			Moments moments;
+			MonotonicDeque minima;
+			MonotonicDeque maxima;
+		};
+
+		double priceAt(uint64_t tick) const { return prices[tick % MAX_STATS_WINDOW]; }
+		template <typename Before>
+		void slide(MonotonicDeque& deque, size_t length, Before before);
+		void resync();
+
+		// The last MAX_STATS_WINDOW ticks, indexed by tick number
+		std::array<double, MAX_STATS_WINDOW> prices{};
+		std::array<double, MAX_STATS_WINDOW> volumes{};
+		std::array<double, MAX_STATS_WINDOW> returns{};
+		std::array<Window, STATS_WINDOWS.size()> windows{};
+		Moments return_moments;
+		double price_volume{ 0.0 }; // Sum of price * volume over the longest window
+		double volume{ 0.0 };
+		SymbolStats stats;
+	};
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+
+namespace StockTracker {
+
+	// Single-writer sequence lock around a trivially copyable value.
+	// The writer never waits. Readers copy the value out and retry only when a write
+	// overlapped the copy. The payload lives in relaxed atomic words so that an
+	// overlapping read is well defined instead of a data race.
+	template <typename T>
+	class SeqLock {
+		static_assert(std::is_trivially_copyable_v<T>, "SeqLock payload must be trivially copyable");
+		static constexpr size_t WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+	public:
+		SeqLock() { store(T{}); }
+		explicit SeqLock(const T& value) { store(value); }
+
+		// Must only ever be called from one thread at a time.
+		void store(const T& value) {
+			std::array<uint64_t, WORDS> buffer{};
+			std::memcpy(buffer.data(), &value, sizeof(T));
+
+			const uint64_t seq = sequence.load(std::memory_order_relaxed);
+			sequence.store(seq + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+			for (size_t i = 0; i < WORDS; ++i) {
+				words[i].store(buffer[i], std::memory_order_relaxed);
+			}
+			sequence.store(seq + 2, std::memory_order_release);
+		}
+
+		T load() const {
+			std::array<uint64_t, WORDS> buffer;
+			uint64_t before = 0;
+			uint64_t after = 0;
+			do {
+				before = sequence.load(std::memory_order_acquire);
+				for (size_t i = 0; i < WORDS; ++i) {
+					buffer[i] = words[i].load(std::memory_order_relaxed);
+				}
+				std::atomic_thread_fence(std::memory_order_acquire);
+				after = sequence.load(std::memory_order_relaxed);
+			} while ((before & 1) != 0 || before != after);
+
+			T value;
+			std::memcpy(static_cast<void*>(&value), buffer.data(), sizeof(T));
+			return value;
+		}
+
+		SeqLock(const SeqLock&) = delete;
+		SeqLock& operator=(const SeqLock&) = delete;
+
+	private:
+		std::atomic<uint64_t> sequence{ 0 };
+		std::array<std::atomic<uint64_t>, WORDS> words{};
+	};
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include "FlatSymbolMap.h"
+#include "QuoteFields.h"
+#include <cstdint>
+
+
+namespace StockTracker {
+
+	struct SequenceCheck {
+		enum class Result {
+			InOrder,  // Next in sequence, first seen, or unnumbered
+			Gap,      // Ticks were lost before this one; it is still applied
+			Stale,    // A duplicate or older than one already applied; drop it
+			Reset,    // The publisher restarted its numbering; applied and tracked from here
+		};
+
+		Result result{ Result::InOrder };
+		uint64_t missed{ 0 };     // Gap: sequence numbers skipped
+		int64_t gap_from_ns{ 0 }; // Gap: timestamp of the last tick before it
+	};
+
+	// Per-symbol sequence numbers seen on the feed, for noticing ticks that PUB/SUB
+	// dropped at a high-water mark. A lower sequence is stale unless the tick is newer
+	// than the last one or the sequence jumped back by more than RESET_DISTANCE; then the
+	// DataService was restarted and numbering starts over. Update thread only.
+	class SequenceTracker {
+	public:
+		// Records the tick as the symbol's newest unless it is stale.
+		SequenceCheck check(const QuoteTick& tick);
+
+		// Called when a symbol stops being received, so a later subscription
+		// doesn't read the time in between as a gap.
+		void forget(SymbolKey key) { last.erase(key); }
+
+	private:
+		static constexpr uint64_t RESET_DISTANCE = 1 << 16; // Far more than a feed ever reorders
+
+		struct Last {
+			uint64_t sequence{ 0 };
+			int64_t timestamp_ns{ 0 };
+		};
+
+		FlatSymbolMap<Last> last;
+	};
+}
@@ -0,0 +1,20 @@
+#pragma once
+#include "QuoteStore.h"
+#include <string>
+#include <utility>
+#include <vector>
+
+
+namespace StockTracker::SnapshotCache {
+
+	// Last known subscriptions and prices, saved on exit and loaded at startup so the
+	// first screen is drawn from disk while the DataService handshake is still running.
+	// The service stays authoritative: its subscription list replaces the cached one.
+	using Entries = std::vector<std::pair<std::string, StockData>>;
+
+	// Returns no entries if the file is missing; a corrupt file is reported and ignored.
+	Entries load(const std::string& path);
+
+	// Writes a temporary file and renames it over `path`, so a crash never leaves half a cache.
+	bool save(const std::string& path, const Entries& entries);
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+
+namespace StockTracker {
+
+	// A symbol of up to 8 characters packed into one integer. Symbols become keys where
+	// quotes are decoded; after that, lookups hash and compare a single word and never
+	// build a heap string. 0 is never a valid key.
+	using SymbolKey = uint64_t;
+	constexpr SymbolKey NO_SYMBOL = 0;
+	constexpr size_t MAX_SYMBOL_LENGTH = sizeof(SymbolKey);
+
+	// NO_SYMBOL for symbols that are empty or too long to pack.
+	inline SymbolKey symbolKey(std::string_view symbol) {
+		if (symbol.empty() || symbol.size() > MAX_SYMBOL_LENGTH) {
+			return NO_SYMBOL;
+		}
+		SymbolKey key = 0;
+		std::memcpy(&key, symbol.data(), symbol.size());
+		return key;
+	}
+
+	// The characters of `key`, which must outlive the view.
+	inline std::string_view symbolName(const SymbolKey& key) {
+		const char* text = reinterpret_cast<const char*>(&key);
+		size_t length = 0;
+		while (length < MAX_SYMBOL_LENGTH && text[length] != '\0') {
+			++length;
+		}
+		return { text, length };
+	}
+}
@@ -0,0 +1,17 @@
+#pragma once
+#include <cstddef>
+
+
+namespace StockTracker {
+
+	struct TerminalSize {
+		size_t columns{ 80 };
+		size_t rows{ 24 };
+	};
+
+	// Size of the attached console, or 80x24 when stdout is not a terminal.
+	TerminalSize queryTerminalSize();
+
+	// Lets the console show UTF-8 output (Braille graphs). No-op outside Windows.
+	void enableUtf8Output();
+}
@@ -0,0 +1,13 @@
+#pragma once
+#include <cstddef>
+
+
+namespace StockTracker {
+
+	// Number of cores the scheduler can use, at least 1.
+	size_t coreCount();
+
+	// Restricts the calling thread to one core, wrapping `core` around coreCount().
+	// Returns false, leaving the thread unpinned, where that isn't supported.
+	bool pinCurrentThread(size_t core);
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+
+namespace StockTracker {
+
+	// Read-only view over a contiguous run of one column, oldest sample first.
+	// A minimal stand-in for C++20 std::span.
+	template <typename T>
+	class Span {
+	public:
+		Span() = default;
+		Span(const T* data, size_t size) : first(data), count(size) {}
+
+		const T* data() const { return first; }
+		size_t size() const { return count; }
+		bool empty() const { return count == 0; }
+		const T* begin() const { return first; }
+		const T* end() const { return first + count; }
+		const T& operator[](size_t i) const { return first[i]; }
+		const T& back() const { return first[count - 1]; }
+
+	private:
+		const T* first{ nullptr };
+		size_t count{ 0 };
+	};
+
+	// Reader-owned copy of a history window. Reusing one instance across calls
+	// avoids allocating once its vectors have grown to the window size.
+	struct TickSeries {
+		std::vector<int64_t> timestamps; // Nanoseconds since the epoch
+		std::vector<double> prices;
+		std::vector<double> volumes;     // 0 when the feed has no volume
+
+		size_t size() const { return prices.size(); }
+		bool empty() const { return prices.empty(); }
+		void clear() { timestamps.clear(); prices.clear(); volumes.clear(); }
+		Span<int64_t> timestampSpan() const { return { timestamps.data(), timestamps.size() }; }
+		Span<double> priceSpan() const { return { prices.data(), prices.size() }; }
+		Span<double> volumeSpan() const { return { volumes.data(), volumes.size() }; }
+	};
+
+	// Fixed-capacity per-symbol tick history stored as separate timestamp, price and
+	// volume columns. All storage is allocated up front, so append never allocates.
+	//
+	// Each column is mirrored (slot i and i + capacity hold the same sample), which
+	// makes the newest `depth` samples one contiguous run with no wrap-around split.
+	//
+	// There is a single writer. Other threads read through copyTo(), which validates
+	// the copy against the writer's sequence counters and retries if the samples it
+	// copied were overwritten mid-read. As in SeqLock, the columns are relaxed atomics,
+	// so such an overlapping read is well defined. `WRITE_SLACK` extra slots let a
+	// full-depth copy tolerate that many concurrent appends before a retry is needed.
+	class TickHistory {
+	public:
+		static constexpr size_t WRITE_SLACK = 64;
+
+		explicit TickHistory(size_t depth);
+
+		// Writer thread only.
+		void append(int64_t timestamp_ns, double price, double volume);
+		void clear();
+
+		// Any thread.
+		size_t size() const;
+		size_t depth() const { return max_samples; }
+		size_t copyTo(TickSeries& out, size_t newest = std::numeric_limits<size_t>::max()) const;
+
+		TickHistory(const TickHistory&) = delete;
+		TickHistory& operator=(const TickHistory&) = delete;
+
+	private:
+		size_t windowStart(uint64_t end, size_t count) const { return static_cast<size_t>((end - count) % capacity); }
+
+		size_t max_samples;  // Visible depth
+		size_t capacity;     // Ring slots per column, depth + WRITE_SLACK
+
+		std::vector<std::atomic<int64_t>> time_column; // 2 * capacity, mirrored
+		std::vector<std::atomic<double>> price_column;
+		std::vector<std::atomic<double>> volume_column;
+
+		// Monotonic sample numbers. Samples [tail, head) are valid; `reserved` runs
+		// ahead of `head` while the writer is filling a slot.
+		std::atomic<uint64_t> tail{ 0 };
+		std::atomic<uint64_t> head{ 0 };
+		std::atomic<uint64_t> reserved{ 0 };
+	};
+}
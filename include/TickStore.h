@@ -0,0 +1,94 @@
+#pragma once
+#include "FlatSymbolMap.h"
+#include "TickHistory.h"
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+namespace StockTracker {
+
+	// One tick as stored on disk.
+	struct TickRecord {
+		int64_t timestamp_ns; // Nanoseconds since the epoch
+		double price;
+		double volume;
+	};
+
+	// Append-only, memory-mapped tick files, one per symbol, under one directory.
+	//
+	// Every tick the CLI receives is appended, so history and graphs over any time range
+	// are served locally. A file is a small header followed by fixed-size records in
+	// timestamp order; a tick older than the symbol's newest record is skipped. A sparse
+	// in-memory index of every INDEX_STRIDE'th timestamp narrows a lookup to one block
+	// before the final binary search, so a range query only touches a few pages.
+	//
+	// With a retention period, ticks older than that are dropped when a file is opened and
+	// whenever it fills up; the file only grows if more than half of it is still recent.
+	//
+	// Each ingest thread writes through its own Writer, and each symbol has one writer.
+	// Readers get views straight into the mapping. A view holds off remapping and the
+	// writer's ingest while it is alive, so copy what is needed out of it and let it go.
+	class TickStore {
+		class File;
+
+	public:
+		// Zero-copy view of a time range, oldest first.
+		class Range {
+		public:
+			Span<TickRecord> records() const { return view; }
+
+		private:
+			friend class TickStore;
+			std::shared_lock<std::shared_mutex> lock;
+			Span<TickRecord> view;
+		};
+
+		// One ingest thread's handle. It remembers the files that thread has used, so an
+		// append takes no lock after the symbol's first.
+		class Writer {
+		public:
+			explicit Writer(TickStore& store) : store(store) {}
+
+			// Returns false for out-of-order ticks and unusable symbols.
+			bool append(std::string_view symbol, int64_t timestamp_ns, double price, double volume);
+
+		private:
+			TickStore& store;
+			FlatSymbolMap<File*> files;
+		};
+
+		// Creates `directory` if needed and opens the files already in it. `retention_ns`
+		// 0 keeps every tick. Throws std::runtime_error if the directory can't be created.
+		explicit TickStore(std::string directory, int64_t retention_ns = 0);
+		~TickStore();
+
+		// Readers, callable from any thread. Range bounds are inclusive.
+		Range range(std::string_view symbol, int64_t from_ns, int64_t to_ns) const;
+		Range newest(std::string_view symbol, size_t count) const;
+		std::optional<int64_t> firstTimestamp(std::string_view symbol) const;
+		std::optional<int64_t> lastTimestamp(std::string_view symbol) const;
+
+		TickStore(const TickStore&) = delete;
+		TickStore& operator=(const TickStore&) = delete;
+
+	private:
+		static constexpr size_t INDEX_STRIDE = 256;
+
+		File* find(std::string_view symbol) const;
+		File* findOrOpen(SymbolKey key); // For writers, whose own lookups miss only once per symbol
+		File* open(SymbolKey key);
+
+		std::string directory;
+		int64_t retention_ns;
+
+		// Writers insert under the exclusive lock and nothing is erased.
+		mutable std::shared_mutex files_mutex;
+		FlatSymbolMap<File*> files; // Null for symbols whose file couldn't be opened
+		std::vector<std::unique_ptr<File>> owned;
+	};
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include <string>
+#include <string_view>
+
+
+namespace StockTracker::Topics {
+
+	// Feed messages are sent as two frames, [topic][payload], so subscribers can filter
+	// on the topic and ZMQ drops unwanted symbols before anything is decoded.
+	// Quote updates for a symbol go to its quote topic. Replies to requests (query,
+	// history, subscription list) and errors go to CONTROL.
+	// Topics end in ';' so the prefix match can't confuse "Q:AA;" with "Q:AAPL;".
+
+	constexpr std::string_view CONTROL = "C;";
+
+	inline std::string quote(std::string_view symbol) {
+		std::string topic;
+		topic.reserve(symbol.size() + 3);
+		topic.append("Q:").append(symbol).push_back(';');
+		return topic;
+	}
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include <cstddef>
+
+
+namespace StockTracker {
+
+	// Inner loops of the correlation matrix, as plain scalar code and with the widest
+	// SIMD instructions the build targets (AVX, SSE2 or NEON; scalar otherwise). Both
+	// are always built so the benchmark can compare them.
+	struct VectorKernels {
+		const char* name;
+
+		// Sum of a[i] * b[i].
+		double (*dot)(const double* a, const double* b, size_t n);
+
+		// row[i] += xa * a[i] - xb * b[i]: one row of adding one outer product and
+		// removing another.
+		void (*update)(double* row, double xa, const double* a, double xb, const double* b, size_t n);
+
+		static const VectorKernels& scalar();
+		static const VectorKernels& simd();
+	};
+}
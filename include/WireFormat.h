@@ -0,0 +1,146 @@
+#pragma once
+#include "QuoteFields.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+namespace StockTracker {
+	namespace Wire {
+
+		// Fixed-layout binary encoding for the hot messages (quotes and price history).
+		// It sits alongside the JSON encoding: a frame is binary if it starts with MAGIC,
+		// anything else is decoded as JSON, so both can share one socket while debugging.
+		//
+		// All fields are little-endian and naturally aligned within the frame.
+		//
+		//   Header (24 bytes)
+		//     0  uint32  magic "TKRB"
+		//     4  uint16  version
+		//     6  uint16  RecordType
+		//     8  uint32  record count
+		//    12  uint32  reserved, 0
+		//    16  char[8] symbol for PriceHistory, zero padded (unused for Quote)
+		//
+		//   Record (56 bytes), `count` of them after the header
+		//     0  char[8] symbol, zero padded
+		//     8  char[4] currency, zero padded
+		//    12  uint32  flags (RecordFlags)
+		//    16  int64   timestamp, ns since the epoch
+		//    24  double  price
+		//    32  double  change percent
+		//    40  double  volume
+		//    48  uint64  per-symbol sequence number (HasSequence), added in version 2
+		//
+		// Version 1 frames (48-byte records, no sequence) are still accepted.
+
+		constexpr uint32_t MAGIC = 0x42524B54; // "TKRB" in memory order
+		constexpr uint16_t VERSION = 2;
+		constexpr size_t HEADER_SIZE = 24;
+		constexpr size_t RECORD_SIZE = 56;
+		constexpr size_t RECORD_SIZE_V1 = 48;
+
+		enum class RecordType : uint16_t {
+			Quote = 1,
+			PriceHistory = 2,
+		};
+
+		enum RecordFlags : uint32_t {
+			HasChangePercent = 1u << 0,
+			HasVolume = 1u << 1,
+			HasSequence = 1u << 2,
+		};
+
+		namespace detail {
+			template <typename T>
+			T load(const unsigned char* at) {
+				T value;
+				std::memcpy(&value, at, sizeof(T));
+				return value;
+			}
+
+			inline std::string_view loadText(const unsigned char* at, size_t capacity) {
+				const char* text = reinterpret_cast<const char*>(at);
+				const void* nul = std::memchr(text, '\0', capacity);
+				return { text, nul ? static_cast<size_t>(static_cast<const char*>(nul) - text) : capacity };
+			}
+		}
+
+		// One record read in place from the frame. Accessors decode on demand.
+		class QuoteView {
+		public:
+			QuoteView(const unsigned char* record, size_t record_size) : base(record), record_size(record_size) {}
+
+			std::string_view symbol() const { return detail::loadText(base, 8); }
+			std::string_view currency() const { return detail::loadText(base + 8, 4); }
+			uint32_t flags() const { return detail::load<uint32_t>(base + 12); }
+			int64_t timestampNs() const { return detail::load<int64_t>(base + 16); }
+			double price() const { return detail::load<double>(base + 24); }
+			double changePercent() const { return detail::load<double>(base + 32); }
+			double volume() const { return detail::load<double>(base + 40); }
+			uint64_t sequence() const { return record_size > RECORD_SIZE_V1 ? detail::load<uint64_t>(base + 48) : 0; }
+
+			QuoteTick tick() const;
+
+		private:
+			const unsigned char* base;
+			size_t record_size;
+		};
+
+		// Validated view over a whole binary frame. Holds no copies: the frame must
+		// outlive the view and every QuoteTick taken from it.
+		class FrameView {
+		public:
+			class iterator {
+			public:
+				using iterator_category = std::forward_iterator_tag;
+				using value_type = QuoteTick;
+				using difference_type = std::ptrdiff_t;
+				using pointer = const QuoteTick*;
+				using reference = QuoteTick;
+
+				iterator(const unsigned char* at, size_t stride) : at(at), stride(stride) {}
+				QuoteTick operator*() const { return QuoteView(at, stride).tick(); }
+				iterator& operator++() { at += stride; return *this; }
+				iterator operator++(int) { iterator old = *this; at += stride; return old; }
+				bool operator==(const iterator& other) const { return at == other.at; }
+				bool operator!=(const iterator& other) const { return at != other.at; }
+
+			private:
+				const unsigned char* at;
+				size_t stride;
+			};
+
+			// True if the frame carries the binary magic, whether or not it is well formed.
+			static bool isBinary(const void* data, size_t size);
+
+			// Returns nullopt if the frame is not a well-formed binary frame of a known version.
+			static std::optional<FrameView> parse(const void* data, size_t size);
+
+			RecordType type() const { return static_cast<RecordType>(detail::load<uint16_t>(base + 6)); }
+			std::string_view symbol() const { return detail::loadText(base + 16, 8); }
+			size_t size() const { return count; }
+			QuoteView operator[](size_t i) const { return QuoteView(base + HEADER_SIZE + i * record_size, record_size); }
+			iterator begin() const { return iterator(base + HEADER_SIZE, record_size); }
+			iterator end() const { return iterator(base + HEADER_SIZE + count * record_size, record_size); }
+
+		private:
+			FrameView(const unsigned char* base, size_t count, size_t record_size)
+				: base(base), count(count), record_size(record_size) {}
+
+			const unsigned char* base;
+			size_t count;
+			size_t record_size; // Depends on the frame's version
+		};
+
+		// Encoders, used by publishers and the benchmarks. `out` is overwritten and
+		// its capacity reused.
+		void encodeQuote(const QuoteTick& tick, std::string& out);
+		void encodeHistory(std::string_view symbol, const std::vector<QuoteTick>& ticks, std::string& out);
+	}
+}
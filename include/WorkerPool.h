@@ -0,0 +1,48 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+
+namespace StockTracker {
+
+	// Threads kept alive between parallel loops, so a loop costs a wakeup rather than a
+	// thread creation per worker. The caller of run() works too, taking task indices from
+	// the same counter, so a pool of n workers runs n + 1 tasks at once. If a thread can't
+	// be created the pool carries on with the ones it has, down to the caller alone.
+	class WorkerPool {
+	public:
+		// With `first_core`, worker t is pinned to core first_core + t, wrapped around.
+		explicit WorkerPool(size_t workers, std::optional<size_t> first_core = std::nullopt);
+		~WorkerPool();
+
+		// Calls task(i) for every i below `count` and returns when all have finished.
+		// One thread calls run() at a time.
+		void run(size_t count, const std::function<void(size_t)>& task);
+
+		size_t threads() const { return workers.size() + 1; } // Including the caller
+
+		WorkerPool(const WorkerPool&) = delete;
+		WorkerPool& operator=(const WorkerPool&) = delete;
+
+	private:
+		void work(std::optional<size_t> core);
+
+		std::vector<std::thread> workers;
+
+		std::mutex mutex;
+		std::condition_variable start;
+		std::condition_variable done;
+		const std::function<void(size_t)>* task{ nullptr }; // Guarded by mutex
+		size_t count{ 0 };      // Guarded by mutex
+		size_t generation{ 0 }; // Guarded by mutex; bumped by every run()
+		size_t busy{ 0 };       // Guarded by mutex; workers still in this run
+		bool stopping{ false }; // Guarded by mutex
+		std::atomic<size_t> next{ 0 }; // Next task index to take
+	};
+}
@@ -0,0 +1,133 @@
+#include "AlertBook.h"
+#include <algorithm>
+#include <utility>
+
+
+namespace StockTracker {
+    namespace {
+        constexpr std::pair<std::string_view, AlertCondition> CONDITION_NAMES[] = {
+            { ">", AlertCondition::Above },
+            { "above", AlertCondition::Above },
+            { "<", AlertCondition::Below },
+            { "below", AlertCondition::Below },
+            { "crosses", AlertCondition::Crosses },
+        };
+    }
+
+    std::optional<AlertCondition> parseAlertCondition(std::string_view text) {
+        for (const auto& [name, condition] : CONDITION_NAMES) {
+            if (name == text) {
+                return condition;
+            }
+        }
+        return std::nullopt;
+    }
+
+    std::string_view alertConditionName(AlertCondition condition) {
+        switch (condition) {
+        case AlertCondition::Above: return "above";
+        case AlertCondition::Below: return "below";
+        case AlertCondition::Crosses: return "crosses";
+        }
+        return {};
+    }
+
+    AlertBook::Thresholds& AlertBook::thresholds(SymbolAlerts& entry, AlertCondition condition) {
+        switch (condition) {
+        case AlertCondition::Above: return entry.above;
+        case AlertCondition::Below: return entry.below;
+        case AlertCondition::Crosses: break;
+        }
+        return entry.crosses;
+    }
+
+    void AlertBook::add(const Alert& alert, std::optional<double> price) {
+        SymbolAlerts* const* found = symbols.find(alert.symbol);
+        SymbolAlerts* entry = found ? *found : nullptr;
+        if (!entry) {
+            entry = &storage.emplace_back();
+            symbols.insert(alert.symbol, entry);
+        }
+        if (!entry->last_price) {
+            entry->last_price = price;
+        }
+        thresholds(*entry, alert.condition).emplace(alert.threshold, alert.id);
+        alerts.emplace(alert.id, alert);
+    }
+
+    bool AlertBook::remove(uint64_t id) {
+        const auto it = alerts.find(id);
+        if (it == alerts.end()) {
+            return false;
+        }
+        const Alert& alert = it->second;
+        Thresholds& map = thresholds(**symbols.find(alert.symbol), alert.condition);
+        const auto [first, last] = map.equal_range(alert.threshold);
+        map.erase(std::find_if(first, last, [id](const auto& entry) { return entry.second == id; }));
+        alerts.erase(it);
+        return true;
+    }
+
+    size_t AlertBook::clear() {
+        const size_t removed = alerts.size();
+        symbols.forEach([](SymbolKey, SymbolAlerts* entry) {
+            entry->above.clear();
+            entry->below.clear();
+            entry->crosses.clear();
+        });
+        alerts.clear();
+        return removed;
+    }
+
+    template <typename Iterator>
+    void AlertBook::fire(Thresholds& map, Iterator first, Iterator last, double price, int64_t timestamp_ns,
+        std::vector<FiredAlert>& fired)
+    {
+        const size_t start = fired.size();
+        for (auto it = first; it != last; ++it) {
+            const auto alert = alerts.find(it->second);
+            fired.push_back({ alert->second, price, timestamp_ns });
+            alerts.erase(alert);
+        }
+        map.erase(first, last);
+        std::sort(fired.begin() + start, fired.end(),
+            [](const FiredAlert& a, const FiredAlert& b) { return a.alert.id < b.alert.id; });
+    }
+
+    void AlertBook::check(SymbolKey symbol, double price, int64_t timestamp_ns, std::vector<FiredAlert>& fired) {
+        SymbolAlerts* const* found = symbols.find(symbol);
+        if (!found) {
+            return;
+        }
+        SymbolAlerts& entry = **found;
+
+        if (!entry.above.empty()) {
+            fire(entry.above, entry.above.begin(), entry.above.lower_bound(price), price, timestamp_ns, fired);
+        }
+        if (!entry.below.empty()) {
+            fire(entry.below, entry.below.upper_bound(price), entry.below.end(), price, timestamp_ns, fired);
+        }
+        if (!entry.crosses.empty() && entry.last_price && price != *entry.last_price) {
+            // Rising: (last, price]; falling: [price, last)
+            const double last = *entry.last_price;
+            const auto first = price > last ? entry.crosses.upper_bound(last) : entry.crosses.lower_bound(price);
+            const auto end = price > last ? entry.crosses.upper_bound(price) : entry.crosses.lower_bound(last);
+            fire(entry.crosses, first, end, price, timestamp_ns, fired);
+        }
+        entry.last_price = price;
+    }
+
+    void AlertBook::forgetPrice(SymbolKey symbol) {
+        if (SymbolAlerts* const* found = symbols.find(symbol)) {
+            (*found)->last_price.reset();
+        }
+    }
+
+    void AlertBook::list(std::vector<Alert>& out) const {
+        out.clear();
+        for (const auto& [id, alert] : alerts) {
+            out.push_back(alert);
+        }
+        std::sort(out.begin(), out.end(), [](const Alert& a, const Alert& b) { return a.id < b.id; });
+    }
+}
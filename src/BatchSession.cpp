@@ -0,0 +1,211 @@
+#include "BatchSession.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <sstream>
+#include <vector>
+
+
+namespace StockTracker {
+    namespace {
+        const char* CSV_HEADER = "id,command,symbol,status,price,change_percent,currency,timestamp_ns,points,latency_ms\n";
+
+        // Quotes a CSV field only when it needs it
+        std::string csvField(const std::string& text) {
+            if (text.find_first_of(",\"\n") == std::string::npos) {
+                return text;
+            }
+            std::string quoted = "\"";
+            for (char c : text) {
+                quoted += c;
+                if (c == '"') {
+                    quoted += '"';
+                }
+            }
+            return quoted + "\"";
+        }
+    }
+
+    BatchReply BatchReply::fromTick(const QuoteTick& tick) {
+        BatchReply reply;
+        reply.price = tick.price;
+        reply.change_percent = tick.change_percent;
+        reply.currency = std::string(tick.currency);
+        reply.timestamp_ns = tick.timestamp_ns;
+        return reply;
+    }
+
+    BatchSession::BatchSession(OutputQueue& output, BatchFormat format)
+        : output(output)
+        , format(format)
+    {
+        if (format == BatchFormat::Csv) {
+            output.pushWaiting(CSV_HEADER);
+        }
+    }
+
+    size_t BatchSession::expect(const std::string& command, const std::string& symbol, MessageType reply, size_t services) {
+        flush();
+        std::lock_guard<std::mutex> lock(mutex);
+        const size_t id = next_id++;
+        pending[{ reply, symbolKey(symbol) }].push_back(
+            { id, command, symbol, std::chrono::steady_clock::now(), std::max<size_t>(services, 1) });
+        ++outstanding;
+        return id;
+    }
+
+    void BatchSession::complete(const std::string& command, const std::string& symbol, const BatchReply& reply) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            write({ next_id++, command, symbol, std::chrono::steady_clock::now() }, reply);
+        }
+        flush();
+    }
+
+    bool BatchSession::resolve(MessageType type, std::string_view symbol, const BatchReply& reply) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            const auto it = pending.find({ type, symbolKey(symbol) });
+            if (it == pending.end()) {
+                return false;
+            }
+            const Pending& request = it->second.front();
+            write(request, reply);
+            if (request.errors_left > 1) {
+                stray_errors[it->first.second] += request.errors_left - 1;
+            }
+            it->second.pop_front();
+            if (it->second.empty()) {
+                pending.erase(it);
+            }
+            --outstanding;
+        }
+        replied.notify_all();
+        return true;
+    }
+
+    bool BatchSession::resolveError(std::string_view symbol, const std::string& error) {
+        // Errors don't say which request failed, so the oldest one for the symbol takes it.
+        // An error without a symbol goes to the oldest request of all. A service that doesn't
+        // own the symbol may refuse a request another service answers; such errors are
+        // absorbed until the request has been refused by every service it went to.
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            const SymbolKey key = symbolKey(symbol);
+            if (auto stray = stray_errors.find(key); !symbol.empty() && stray != stray_errors.end()) {
+                if (--stray->second == 0) {
+                    stray_errors.erase(stray);
+                }
+                return true;
+            }
+            auto oldest = pending.end();
+            for (auto it = pending.begin(); it != pending.end(); ++it) {
+                if ((symbol.empty() || it->first.second == key)
+                    && (oldest == pending.end() || it->second.front().id < oldest->second.front().id)) {
+                    oldest = it;
+                }
+            }
+            if (oldest == pending.end()) {
+                return false;
+            }
+
+            if (--oldest->second.front().errors_left > 0) {
+                return true;
+            }
+            BatchReply reply;
+            reply.status = "error: " + error;
+            write(oldest->second.front(), reply);
+            oldest->second.pop_front();
+            if (oldest->second.empty()) {
+                pending.erase(oldest);
+            }
+            --outstanding;
+        }
+        replied.notify_all();
+        return true;
+    }
+
+    bool BatchSession::finish(std::chrono::steady_clock::time_point deadline) {
+        // Results are written as they come in until the last reply or the deadline
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            replied.wait_until(lock, deadline, [this] { return outstanding == 0 || !rows.empty(); });
+            if (rows.empty()) {
+                break;
+            }
+            lock.unlock();
+            flush();
+            lock.lock();
+        }
+
+        // Whatever is left is reported in the order it was sent
+        std::vector<Pending> late;
+        for (auto& [key, requests] : pending) {
+            late.insert(late.end(), requests.begin(), requests.end());
+        }
+        std::sort(late.begin(), late.end(), [](const Pending& a, const Pending& b) { return a.id < b.id; });
+        BatchReply timeout;
+        timeout.status = "timeout";
+        for (const auto& request : late) {
+            write(request, timeout);
+        }
+        pending.clear();
+        outstanding = 0;
+        const bool succeeded = !failed;
+        lock.unlock();
+        flush();
+        return succeeded;
+    }
+
+    void BatchSession::flush() {
+        std::deque<std::string> ready;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ready.swap(rows);
+        }
+        for (auto& row : ready) {
+            output.pushWaiting(std::move(row));
+        }
+    }
+
+    void BatchSession::write(const Pending& request, const BatchReply& reply) {
+        if (reply.status != "ok" && reply.status != "sent") {
+            failed = true;
+        }
+        const double latency_ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - request.sent).count();
+
+        if (format == BatchFormat::JsonLines) {
+            nlohmann::json row = {
+                { "id", request.id },
+                { "command", request.command },
+                { "symbol", request.symbol },
+                { "status", reply.status },
+                { "latency_ms", latency_ms },
+            };
+            if (reply.price) {
+                row["price"] = *reply.price;
+                row["change_percent"] = reply.change_percent.value_or(0.0);
+                row["currency"] = reply.currency;
+                row["timestamp_ns"] = reply.timestamp_ns;
+            }
+            if (reply.points > 0) {
+                row["points"] = reply.points;
+            }
+            rows.push_back(row.dump() + "\n");
+            return;
+        }
+
+        std::ostringstream row;
+        row << request.id << "," << csvField(request.command) << "," << csvField(request.symbol) << ","
+            << csvField(reply.status) << ",";
+        if (reply.price) {
+            row << *reply.price << "," << reply.change_percent.value_or(0.0) << "," << csvField(reply.currency)
+                << "," << reply.timestamp_ns;
+        }
+        else {
+            row << ",,,";
+        }
+        row << "," << reply.points << "," << latency_ms << "\n";
+        rows.push_back(row.str());
+    }
+}
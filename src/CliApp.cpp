@@ -1,34 +1,173 @@
 #include "CliApp.h"
+#include "SnapshotCache.h"
+#include "Terminal.h"
+#include "ThreadAffinity.h"
+#include "Topics.h"
 #include <spdlog/spdlog.h>
+#include <spdlog/sinks/stdout_sinks.h>
+#include <algorithm>
 #include <sstream>
 #include <iomanip>
+#include <cctype>
+#include <charconv>
 #include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <string_view>
 #include <nlohmann/json.hpp>
 
 
 namespace StockTracker {
-    CliApp::CliApp()
-        : publisher(zmq::socket_type::pub)
-        , subscriber(zmq::socket_type::sub)
+    namespace {
+        // Digits only; empty for a sign, any other character or a value that doesn't fit
+        std::optional<uint64_t> parseUnsigned(std::string_view text) {
+            uint64_t value = 0;
+            const char* end = text.data() + text.size();
+            const auto [ptr, ec] = std::from_chars(text.data(), end, value);
+            if (text.empty() || ec != std::errc() || ptr != end) {
+                return std::nullopt;
+            }
+            return value;
+        }
+
+        // "90s", "15m", "2h" or "1d" as nanoseconds; empty if malformed or out of range
+        std::optional<int64_t> parseDurationNs(const std::string& text) {
+            if (text.size() < 2) {
+                return std::nullopt;
+            }
+            int64_t unit_seconds = 0;
+            switch (text.back()) {
+            case 's': unit_seconds = 1; break;
+            case 'm': unit_seconds = 60; break;
+            case 'h': unit_seconds = 3600; break;
+            case 'd': unit_seconds = 86400; break;
+            default: return std::nullopt;
+            }
+            const int64_t unit_ns = unit_seconds * 1'000'000'000;
+            const auto count = parseUnsigned(std::string_view(text).substr(0, text.size() - 1));
+            if (!count || *count > static_cast<uint64_t>(std::numeric_limits<int64_t>::max() / unit_ns)) {
+                return std::nullopt;
+            }
+            return static_cast<int64_t>(*count) * unit_ns;
+        }
+
+        bool isDigit(char c) {
+            return std::isdigit(static_cast<unsigned char>(c)) != 0;
+        }
+
+        int64_t nowNs() {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+        }
+
+        // "1s" or "250ms"
+        std::string intervalLabel(size_t ms) {
+            return ms % 1000 == 0 ? std::to_string(ms / 1000) + "s" : std::to_string(ms) + "ms";
+        }
+    }
+
+    CliApp::CliApp(const CliConfig& config)
+        : CliApp(config, std::make_unique<zmq::context_t>(1), nullptr)
     {
-        publisher.bind("tcp://*:5557");
-        subscriber.connect("tcp://localhost:5556");
+    }
 
-        // Use the specific subscribe method
-        subscriber.setSubscribe("");
+    CliApp::CliApp(const CliConfig& config, zmq::context_t& context)
+        : CliApp(config, nullptr, &context)
+    {
+    }
 
-        // Or use generic socket options if needed
-        subscriber.setTimeout(1000);
+    CliApp::CliApp(const CliConfig& config, std::unique_ptr<zmq::context_t> owned, zmq::context_t* shared)
+        : config(config)
+        , owned_context(std::move(owned))
+        , context(shared ? *shared : *owned_context)
+        , stocks(config.history_depth)
+    {
+        for (const std::string& endpoint : config.request_endpoints) {
+            publishers.emplace_back(context, zmq::socket_type::pub).bind(endpoint);
+        }
 
         //spdlog::info("CLI connected to DataService.");
 
-        // Request subscription data from backend
-        // Small delay to ensure dataservice is ready.
-        std::this_thread::sleep_for(std::chrono::milliseconds(1000));
-        Message msg = Message::makeRequestSubscriptions();
-        //spdlog::info("Sending RequestSubscriptions message");
-        publisher.send(msg); // Send request for subscriptions
+        if (!config.tick_dir.empty()) {
+            try {
+                // Capped at about 200 years so the conversion can't overflow
+                const int64_t retention_h = static_cast<int64_t>(std::min<size_t>(config.tick_retention_h, 2'000'000));
+                tick_store = std::make_unique<TickStore>(config.tick_dir, retention_h * 3'600'000'000'000);
+            }
+            catch (const std::exception& e) {
+                spdlog::warn("Tick store disabled: {}", e.what());
+            }
+        }
+
+        // Everything by default, as the DataService publishes untopiced frames. With topic
+        // filtering only control messages until symbols are subscribed; quote topics are
+        // added per symbol. No receive timeout: processUpdates blocks in zmq::poll until a
+        // message or wakeup arrives.
+        const std::string control_topic(config.topic_filtering ? Topics::CONTROL : "");
+        ranking_views.push_back(&restored_rankings);
+        for (const std::string& endpoint : config.feed_endpoints) {
+            auto shard = std::make_unique<FeedShard>(context, static_cast<uint32_t>(shards.size()), endpoint,
+                config.receive_hwm, control_topic, tick_store.get());
+            shard->handshake_retry = HANDSHAKE_FIRST_RETRY;
+            ranking_views.push_back(&shard->rankings);
+            shards.push_back(std::move(shard));
+        }
+
+        // Show the last session's data straight away. Subscription data is requested from
+        // the backend by each shard's handshake and replaces this once it arrives.
+        restoreCachedSnapshot();
+    }
+
+    void CliApp::restoreCachedSnapshot() {
+        if (config.cache_path.empty()) {
+            return;
+        }
+        // Runs before the workers start, so the topic filters can be set from here. Which
+        // feed publishes a cached symbol isn't known yet, so every shard listens for it.
+        for (const auto& [symbol, data] : SnapshotCache::load(config.cache_path)) {
+            stocks.restore(symbol, data);
+            restored_rankings.update(symbolKey(symbol), data, 0.0);
+            for (auto& shard : shards) {
+                addTopicFilter(*shard, symbol);
+            }
+        }
+    }
+
+    std::chrono::milliseconds CliApp::advanceHandshake(FeedShard& shard) {
+        // Returns how long the worker may sleep before the next attempt is due
+        if (shard.handshake_done) {
+            return std::chrono::milliseconds(-1);
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        if (now < shard.next_handshake) {
+            return std::chrono::ceil<std::chrono::milliseconds>(shard.next_handshake - now);
+        }
+
+        if (shard.handshake_attempts == config.connect_attempts) {
+            spdlog::warn("No reply from the DataService at {} after {} attempts, showing cached data only",
+                shard.endpoint, shard.handshake_attempts);
+            settleHandshake(shard);
+            return std::chrono::milliseconds(-1);
+        }
+
+        sendRequests({ Message::makeRequestSubscriptions() }, shard.index);
+        ++shard.handshake_attempts;
+        shard.next_handshake = now + shard.handshake_retry;
+        const auto wait = shard.handshake_retry;
+        shard.handshake_retry = std::min(shard.handshake_retry * 2, HANDSHAKE_MAX_RETRY);
+        return wait;
+    }
+
+    void CliApp::settleHandshake(FeedShard& shard) {
+        if (!shard.handshake_done) {
+            shard.handshake_done = true;
+            ++settled_shards;
+        }
     }
 
 	void CliApp::handleCommand(const std::string& cmd) {
@@ -36,64 +175,153 @@ namespace StockTracker {
 		std::string command;
 		iss >> command;
 
-		// Get symbol if present
-		std::string symbol;
-		iss >> symbol; // Empty if no symbol provided
+		// Get symbols if present. Commands that take symbols accept several and
+		// send them to the DataService as one batch.
+		std::vector<std::string> symbols;
+		for (std::string word; iss >> word;) {
+			symbols.push_back(word);
+		}
+		std::string symbol = symbols.empty() ? std::string() : symbols.front(); // Empty if no symbol provided
 
         switch (hash(command.c_str())) {
         case Commands::Subscribe:
-            if (!symbol.empty()) {
-                if (!isValidSymbolFormat(symbol)) {
-                    spdlog::info("Invalid symbol format. Symbols should be 1-5 uppercase letters.\n");
-                    return;
+            if (!symbols.empty()) {
+                std::string names;
+                for (const auto& s : symbols) {
+                    if (!isValidSymbolFormat(s)) {
+                        spdlog::info("Invalid symbol format: {}. Symbols should be 1-5 uppercase letters.\n", s);
+                        return;
+                    }
+                    names += (names.empty() ? "" : ", ") + s;
                 }
-                if (confirmAction("subscribe to", symbol)) {
-                    subscribe(symbol);
+                if (confirmAction("subscribe to", names)) {
+                    subscribe(symbols);
                 }
             }
             else {
-                spdlog::warn("Usage: subscribe <symbol>");
+                spdlog::warn("Usage: subscribe <symbol> [symbol...]");
             }
             break;
 
         case Commands::Unsubscribe:
-            if (!symbol.empty()) {
-                unsubscribe(symbol);
+            if (!symbols.empty()) {
+                for (const auto& s : symbols) {
+                    if (!isValidSymbolFormat(s)) {
+                        spdlog::info("Invalid symbol format: {}. Symbols should be 1-5 uppercase letters.\n", s);
+                        return;
+                    }
+                }
+                unsubscribe(symbols);
             }
             else {
-                spdlog::warn("Usage: unsubscribe <symbol>");
+                spdlog::warn("Usage: unsubscribe <symbol> [symbol...]");
             }
             break;
 
         case Commands::Query:
-            if (!symbol.empty()) {
-                query(symbol);
+            if (!symbols.empty()) {
+                query(symbols);
             }
             else {
-                spdlog::warn("Usage: query <symbol>");
+                spdlog::warn("Usage: query <symbol> [symbol...]");
             }
             break;
 
         case Commands::Graph:
             if (!symbol.empty()) {
-                renderFullGraph(symbol);
+                // graph <symbol> [points|all|duration] [braille], options in any order
+                size_t points = GRAPH_POINTS;
+                bool braille = false;
+                std::optional<int64_t> span_ns;
+                for (size_t i = 1; i < symbols.size(); ++i) {
+                    if (symbols[i] == "braille") {
+                        braille = true;
+                    }
+                    else if (auto duration = parseDurationNs(symbols[i])) {
+                        span_ns = duration;
+                    }
+                    else if (symbols[i] == "all") {
+                        points = std::numeric_limits<size_t>::max();
+                    }
+                    else if (auto count = parseUnsigned(symbols[i])) {
+                        points = static_cast<size_t>(std::clamp<uint64_t>(*count, 1, std::numeric_limits<size_t>::max()));
+                    }
+                    else {
+                        spdlog::warn("Usage: graph <symbol> [points|all|duration] [braille]");
+                        return;
+                    }
+                }
+                renderFullGraph(symbol, points, braille, span_ns);
             }
             else {
-                spdlog::warn("Usage: graph <symbol>");
+                spdlog::warn("Usage: graph <symbol> [points|all|duration] [braille]");
             }
             break;
 
-        case Commands::History:
+        case Commands::Stats:
             if (!symbol.empty()) {
-                requestPriceHistory(symbol);
+                renderStats(symbol);
+            }
+            else {
+                spdlog::warn("Usage: stats <symbol>");
+            }
+            break;
+
+        case Commands::Corr:
+            showCorrelations(symbols);
+            break;
+
+        case Commands::Beta:
+            if (symbols.size() == 2) {
+                showBeta(symbols[0], symbols[1]);
             }
             else {
-                spdlog::warn("Usage: history <symbol>");
+                spdlog::warn("Usage: beta <symbol> <index symbol>");
             }
             break;
 
+        case Commands::History:
+            if (!symbols.empty()) {
+                // A trailing duration ("15m") selects a time range from the local tick store
+                std::optional<int64_t> span_ns = parseDurationNs(symbols.back());
+                if (span_ns) {
+                    symbols.pop_back();
+                }
+                else if (isDigit(symbols.back().front())) {
+                    symbols.clear(); // A duration that is malformed or too long, never a symbol
+                }
+                for (const auto& s : symbols) {
+                    if (!isValidSymbolFormat(s)) {
+                        spdlog::info("Invalid symbol format: {}. Symbols should be 1-5 uppercase letters.\n", s);
+                        return;
+                    }
+                }
+                if (!symbols.empty()) {
+                    showHistory(symbols, span_ns);
+                    break;
+                }
+            }
+            spdlog::warn("Usage: history <symbol> [symbol...] [duration, e.g. 15m]");
+            break;
+
         case Commands::List:
-            listStocks();
+            listStocks(symbols, RankKey::Symbol, std::numeric_limits<size_t>::max());
+            break;
+
+        case Commands::Top:
+            listStocks(symbols, RankKey::Movers, TOP_DEFAULT);
+            break;
+
+        case Commands::Alert:
+            alertCommand(symbols);
+            break;
+
+        case Commands::Watch:
+            watchStocks();
+            break;
+
+        case Commands::Metrics:
+            showMetrics();
             break;
 
         case Commands::Help:
@@ -111,7 +339,8 @@ namespace StockTracker {
 
         case Commands::SetCurrency:
             if (!symbol.empty()) {
-                std::transform(symbol.begin(), symbol.end(), symbol.begin(), ::toupper);
+                std::transform(symbol.begin(), symbol.end(), symbol.begin(),
+                    [](char c) { return static_cast<char>(std::toupper(static_cast<unsigned char>(c))); });
                 setCurrency(symbol);
             }
             else {
@@ -121,141 +350,539 @@ namespace StockTracker {
 
         default:
             spdlog::warn("Unknown command: {}", command);
-            std::cout << "Type 'help' for available commands and safety tips.\n";
+            output.line() << "Type 'help' for available commands and safety tips.\n";
             break;
         }
 	}
 
-    void CliApp::renderStockList() {
-        if (stocks.empty()) {
-            std::cout << "No stocks subscribed." << std::endl;
+    void CliApp::renderFullGraph(const std::string& symbol, size_t points, bool braille, std::optional<int64_t> span_ns) {
+        if (span_ns) {
+            // Time ranges come from the tick store, which reaches back past the in-memory history
+            graph_series.clear();
+            if (tick_store) {
+                const int64_t now_ns = nowNs();
+                const auto range = tick_store->range(symbol, now_ns - *span_ns, now_ns);
+                for (const TickRecord& record : range.records()) {
+                    graph_series.prices.push_back(record.price);
+                }
+            }
+            points = 0; // No running min/max for an arbitrary range
+        }
+        else {
+            stocks.copyHistory(symbol, graph_series, points);
+        }
+        if (graph_series.empty()) {
+            output.line() << "No data available for " << symbol << "\n";
             return;
         }
 
-        std::cout << "Subscribed Stocks:" << std::endl;
-        for (const auto& [symbol, data] : stocks) {
-            std::cout << symbol << ": ";
-            // Get the appropriate currency symbol
-            if (data.currency == "USD") {
-                std::cout << "$";
-            }
-            else if (data.currency == "EUR") {
-                std::cout << "";
+        const auto price_history = graph_series.priceSpan();
+        GraphOptions options;
+        options.width = queryTerminalSize().columns;
+        options.height = GRAPH_HEIGHT;
+        options.braille = braille;
+
+        // The default window scales from its running min/max instead of rescanning. A tick can
+        // land between the copy and this read, so the range is widened to cover both.
+        // Other lengths take their range from the rasterizer's bucket pass.
+        if (points == GRAPH_POINTS) {
+            const WindowStats window = stocks.stats(symbol).value_or(SymbolStats{}).windows[GRAPH_WINDOW];
+            if (window.count > 0) {
+                options.bounds = GraphBounds{ std::min(window.min, price_history.back()),
+                    std::max(window.max, price_history.back()) };
             }
-            else if (data.currency == "GBP") {
-                std::cout << "";
+        }
+
+        if (braille) {
+            enableUtf8Output();
+        }
+        const std::string& frame = graph_rasterizer.render(price_history, options);
+        output.push("Stock Price Graph for " + symbol + ":\n" + frame);
+    }
+
+    void CliApp::renderStats(const std::string& symbol) {
+        const auto stats = stocks.stats(symbol);
+        if (!stats || stats->ticks == 0) {
+            output.line() << "No data available for " << symbol << "\n";
+            return;
+        }
+
+        auto out = output.line();
+        out << "Rolling stats for " << symbol << " (" << stats->ticks << " ticks)\n"
+            << std::fixed << std::setprecision(2)
+            << "  window      SMA      EMA   StdDev      Min      Max\n";
+        for (size_t i = 0; i < STATS_WINDOWS.size(); ++i) {
+            const WindowStats& window = stats->windows[i];
+            out << "  " << std::setw(6) << STATS_WINDOWS[i]
+                << " " << std::setw(8) << window.sma
+                << " " << std::setw(8) << window.ema
+                << " " << std::setw(8) << window.stddev
+                << " " << std::setw(8) << window.min
+                << " " << std::setw(8) << window.max;
+            if (window.count < STATS_WINDOWS[i]) {
+                out << "  (" << window.count << " ticks so far)";
             }
-            else if (data.currency == "JPY") {
-                std::cout << "";
+            out << "\n";
+        }
+
+        out << "  Volatility (" << MAX_STATS_WINDOW << " ticks): "
+            << std::setprecision(4) << stats->volatility * 100.0 << "% per tick\n";
+        if (stats->vwap > 0.0) {
+            out << "  VWAP (" << MAX_STATS_WINDOW << " ticks): " << std::setprecision(2) << stats->vwap << "\n";
+        }
+        else {
+            out << "  VWAP: n/a (no volume in feed)\n";
+        }
+    }
+
+    void CliApp::showCorrelations(const std::vector<std::string>& args) {
+        // corr [n], corr <symbol>, corr <symbol> <symbol> [...]
+        const char* usage = "Usage: corr [n] | corr <symbol> | corr <symbol> <symbol> [symbol...]";
+        const bool numeric = args.size() == 1 && !args[0].empty() && isDigit(args[0].front());
+        const auto parsed = numeric ? parseUnsigned(args[0]) : std::nullopt;
+        if (numeric && !parsed) {
+            spdlog::warn(usage);
+            return;
+        }
+        const size_t count = parsed ? static_cast<size_t>(std::clamp<uint64_t>(*parsed, 1, std::numeric_limits<size_t>::max())) : CORR_PAIRS;
+        if (!numeric && !std::all_of(args.begin(), args.end(), [this](const std::string& s) { return isValidSymbolFormat(s); })) {
+            spdlog::warn(usage);
+            return;
+        }
+        const SymbolKey only = args.size() == 1 && !numeric ? symbolKey(args[0]) : NO_SYMBOL;
+        if (args.size() > CORR_MATRIX_MAX) {
+            spdlog::warn("corr shows at most {} symbols side by side", CORR_MATRIX_MAX);
+            return;
+        }
+        if (correlations.size() < 2) {
+            output.line() << "Not enough symbols sampled yet; prices are sampled every "
+                << intervalLabel(config.corr_interval_ms) << "\n";
+            return;
+        }
+
+        auto out = output.line();
+        out << std::fixed << std::setprecision(2)
+            << "Correlation of returns over the last " << correlations.window() << " samples, one every "
+            << intervalLabel(config.corr_interval_ms) << " (" << correlations.size() << " symbols):\n";
+
+        if (args.size() > 1) {
+            out << "       ";
+            for (const auto& column : args) {
+                out << std::setw(8) << column;
             }
-            else {
-                std::cout << data.currency << " "; // For other currencies
+            out << "\n";
+            for (const auto& row : args) {
+                out << "  " << std::left << std::setw(5) << row << std::right;
+                for (const auto& column : args) {
+                    const auto value = correlations.correlation(symbolKey(row), symbolKey(column));
+                    if (value) {
+                        out << std::setw(8) << *value;
+                    }
+                    else {
+                        out << std::setw(8) << "n/a";
+                    }
+                }
+                out << "\n";
             }
-            std::cout << std::fixed << std::setprecision(2) << data.current_price
-                << " (" << data.change_percent << "% change)" << std::endl;
+            return;
+        }
+
+        // Strongest pairs, either sign
+        correlations.strongest(count, only, correlation_pairs);
+        if (correlation_pairs.empty()) {
+            out << "  No pairs yet: symbols need price moves in the window\n";
+        }
+        for (const auto& pair : correlation_pairs) {
+            out << "  " << std::left << std::setw(5) << symbolName(pair.a) << " " << std::setw(5) << symbolName(pair.b)
+                << std::right << std::setw(8) << pair.correlation << "\n";
         }
     }
 
-    void CliApp::renderFullGraph(const std::string& symbol) {
-        auto it = stocks.find(symbol);
-        if (it == stocks.end() || it->second.price_history.empty()) {
-            std::cout << "No data available for " << symbol << std::endl;
-            return;
+    void CliApp::showBeta(const std::string& symbol, const std::string& index) {
+        for (const auto& s : { symbol, index }) {
+            if (!isValidSymbolFormat(s)) {
+                spdlog::warn("Invalid symbol format: {}. Symbols should be 1-5 uppercase letters.", s);
+                return;
+            }
+            if (!isStockSubscribed(s)) {
+                spdlog::warn("{} is not subscribed", s);
+                return;
+            }
         }
 
-        const auto& data = it->second;
-        const auto& price_history = data.price_history;
+        // Beta: covariance with the index over the index's variance
+        const auto beta = correlations.beta(symbolKey(symbol), symbolKey(index));
+        if (!beta) {
+            output.line() << "No beta for " << symbol << " yet: " << index << " hasn't moved in the last "
+                << correlations.window() << " samples (one every " << intervalLabel(config.corr_interval_ms) << ")\n";
+            return;
+        }
+        const auto correlation = correlations.correlation(symbolKey(symbol), symbolKey(index));
+        auto out = output.line();
+        out << std::fixed << std::setprecision(2) << "Beta of " << symbol << " to " << index << ": " << *beta;
+        if (correlation) {
+            out << " (correlation " << *correlation << ")";
+        }
+        out << " over the last " << correlations.window() << " samples, one every "
+            << intervalLabel(config.corr_interval_ms) << "\n";
+    }
 
-        // Calculate min and max prices
-        double min_price = *std::min_element(price_history.begin(), price_history.end());
-        double max_price = *std::max_element(price_history.begin(), price_history.end());
-        double range = max_price - min_price;
+    // Commands
+    // --------------------------------------------
+    void CliApp::subscribe(const std::vector<std::string>& symbols) {
+        std::vector<Message> requests;
+        for (const auto& symbol : symbols) {
+            requests.push_back(Message::makeSubscribe(symbol));
+        }
+        sendRequests(requests);
 
-        // Set graph height (number of rows)
-        int graph_height = 10;
+        // Start receiving the quotes without waiting for the confirmations
+        postToShards([this, symbols](FeedShard& shard) {
+            for (const auto& symbol : symbols) {
+                addTopicFilter(shard, symbol);
+            }
+        });
+        for (const auto& symbol : symbols) {
+            spdlog::info("Subscribing to {}", symbol);
+        }
+    }
 
-        // Create bins for price levels (each bin corresponds to one row in the graph)
-        std::vector<double> levels(graph_height + 1);
-        for (int i = 0; i <= graph_height; ++i) {
-            levels[i] = min_price + (range * i / graph_height); // Calculate level thresholds
+    void CliApp::unsubscribe(const std::vector<std::string>& symbols) {
+        std::vector<Message> requests;
+        for (const auto& symbol : symbols) {
+            requests.push_back(Message::makeUnsubscribe(symbol));
         }
+        sendRequests(requests);
 
-        std::cout << "Stock Price Graph for " << symbol << ":\n";
+        stocks.erase(symbols);
+        for (const auto& symbol : symbols) {
+            restored_rankings.erase(symbolKey(symbol));
+            spdlog::info("Unsubscribed from {}", symbol);
+        }
+        postToShards([this, symbols](FeedShard& shard) {
+            for (const auto& symbol : symbols) {
+                removeTopicFilter(shard, symbol);
+            }
+        });
+    }
 
-        // Render each row (each price level)
-        for (int i = graph_height; i >= 0; --i) {
-            std::cout << std::fixed << std::setw(6) << std::setprecision(2) << levels[i] << " | ";
+    void CliApp::query(const std::vector<std::string>& symbols) {
+        // Send query request to DataService
+        std::vector<Message> requests;
+        for (const auto& symbol : symbols) {
+            requests.push_back(Message::makeQuery(symbol));
+        }
+        sendRequests(requests);
+    }
 
-            // For each price in history, decide whether to place a star or a space
-            for (const auto& price : price_history) {
-                if (price >= levels[i] && price < (i == graph_height ? max_price + 1 : levels[i + 1])) {
-                    std::cout << '*';  // Price falls in this bin
+    void CliApp::requestPriceHistory(const std::vector<std::string>& symbols, bool shown) {
+        std::vector<Message> requests;
+        for (const auto& symbol : symbols) {
+            requests.push_back(Message::makeRequestPriceHistory(symbol));
+        }
+        if (shown) {
+            std::lock_guard<std::mutex> lock(history_requests_mutex);
+            for (const auto& symbol : symbols) {
+                const SymbolKey key = symbolKey(symbol);
+                if (size_t* waiting = history_requests.find(key)) {
+                    ++*waiting;
                 }
                 else {
-                    std::cout << ' ';  // Price doesn't fall in this bin
+                    history_requests.insert(key, 1);
                 }
             }
-            std::cout << std::endl;
         }
+        sendRequests(requests);
+    }
 
-        // Draw the time axis below the graph
-        std::cout << "       ";
-        for (size_t i = 0; i < price_history.size(); ++i) {
-            std::cout << "-";
+    bool CliApp::takeHistoryRequest(SymbolKey key) {
+        std::lock_guard<std::mutex> lock(history_requests_mutex);
+        size_t* waiting = history_requests.find(key);
+        if (!waiting) {
+            return false;
+        }
+        if (--*waiting == 0) {
+            history_requests.erase(key);
         }
-        std::cout << "\n       Time ->\n";
+        return true;
     }
 
-    // Commands
-    // --------------------------------------------
-    void CliApp::subscribe(const std::string& symbol) {
-        //spdlog::info("Sending subscribe request for {}", symbol);
-        Message msg = Message::makeSubscribe(symbol);
-        publisher.send(msg);  // Ensure this send operation is correct
-        spdlog::info("Subscribing to {}", symbol);
+    void CliApp::showHistory(const std::vector<std::string>& symbols, std::optional<int64_t> span_ns) {
+        // Answered from the local tick store when it has the data. Only symbols it can't
+        // cover are requested from the DataService.
+        std::vector<std::string> missing;
+        std::vector<TickRecord> lines;
+        const int64_t now_ns = nowNs();
+        auto out = output.line();
+
+        for (const auto& symbol : symbols) {
+            const auto first = tick_store ? tick_store->firstTimestamp(symbol) : std::nullopt;
+            if (!first) {
+                missing.push_back(symbol);
+                continue;
+            }
+
+            if (!span_ns) {
+                {
+                    const auto range = tick_store->newest(symbol, HISTORY_LINES);
+                    lines.assign(range.records().begin(), range.records().end());
+                }
+                if (lines.size() < HISTORY_LINES) {
+                    missing.push_back(symbol);
+                    continue;
+                }
+                out << "Price history for: " << symbol << " (local)\n";
+                for (const auto& record : lines) {
+                    out << "  $" << record.price << "\n";
+                }
+                continue;
+            }
+
+            // Summarise the range; it may hold far too many ticks to list. The range is copied
+            // out first so the file's writer isn't held off while it is scanned.
+            {
+                const auto range = tick_store->range(symbol, now_ns - *span_ns, now_ns);
+                lines.assign(range.records().begin(), range.records().end());
+            }
+            const size_t count = lines.size();
+            double open = 0.0, high = 0.0, low = 0.0, close = 0.0;
+            if (count > 0) {
+                open = lines.front().price;
+                close = lines.back().price;
+                high = low = open;
+                for (const TickRecord& record : lines) {
+                    high = std::max(high, record.price);
+                    low = std::min(low, record.price);
+                }
+            }
+
+            out << "Price history for: " << symbol << ", last " << (*span_ns / 1'000'000'000) << "s (local)\n";
+            if (count == 0) {
+                out << "  No ticks in range\n";
+            }
+            else {
+                out << "  " << count << " ticks, open $" << open << ", high $" << high
+                    << ", low $" << low << ", close $" << close << "\n";
+            }
+            if (*first > now_ns - *span_ns) {
+                out << "  Local data starts partway into the range, asking the DataService\n";
+                missing.push_back(symbol);
+            }
+        }
+
+        if (!missing.empty()) {
+            requestPriceHistory(missing);
+        }
     }
 
-    void CliApp::unsubscribe(const std::string& symbol) {
-        publisher.send(Message::makeUnsubscribe(symbol));
-        stocks.erase(symbol);
-        spdlog::info("Unsubscribed from {}", symbol);
+    void CliApp::sendRequests(const std::vector<Message>& requests, std::optional<uint32_t> shard) {
+        // One message per request: the DataService reads a single frame from each message.
+        // The lock only keeps a batch together, it is not atomic on the wire. With an endpoint
+        // per feed a request goes to `shard`'s service, or else to the one whose feed owns the
+        // symbol; a symbol no feed has published yet is asked of every service.
+        std::lock_guard<std::mutex> lock(publisher_mutex);
+        for (const auto& request : requests) {
+            const std::string payload = request.serialize();
+            const std::optional<uint32_t> target = shard ? shard : stocks.writerOf(request.symbol);
+            for (size_t i = 0; i < publishers.size(); ++i) {
+                if (publishers.size() == 1 || !target || *target == i) {
+                    publishers[i].send(zmq::buffer(payload), zmq::send_flags::none);
+                }
+            }
+        }
     }
 
-    void CliApp::query(const std::string& symbol) {
-        // Send query request to DataService
-        Message msg = Message::makeQuery(symbol);
-        publisher.send(msg);
+    size_t CliApp::requestFanout(const std::string& symbol) const {
+        // A shared endpoint reaches every feed's service; routed requests reach one once owned
+        if (publishers.size() == 1) {
+            return shards.size();
+        }
+        return stocks.writerOf(symbol) ? 1 : publishers.size();
+    }
 
-        //spdlog::info("Requested current price for {}", symbol);
+    void CliApp::listStocks(const std::vector<std::string>& options, RankKey default_key, size_t default_count) {
+        // [change|movers|price|volume|symbol] [asc|desc] [top <n> | <n>] [page <n>], in any order
+        RankKey key = default_key;
+        std::optional<bool> descending;
+        size_t count = default_count;
+        size_t page = 1;
+        const auto positive = [](const std::string& word) -> size_t {
+            // Nine digits at most, so page * count can't overflow
+            const auto value = parseUnsigned(word);
+            return value && *value < 1'000'000'000 ? static_cast<size_t>(*value) : 0;
+        };
+        for (size_t i = 0; i < options.size(); ++i) {
+            const std::string& word = options[i];
+            if (auto parsed = parseRankKey(word)) {
+                key = *parsed;
+            }
+            else if (word == "asc" || word == "desc") {
+                descending = word == "desc";
+            }
+            else if ((word == "top" || word == "page") && i + 1 < options.size() && positive(options[i + 1]) > 0) {
+                (word == "top" ? count : page) = positive(options[++i]);
+            }
+            else if (positive(word) > 0) {
+                count = positive(word);
+            }
+            else {
+                spdlog::warn("Usage: list|top [change|movers|price|volume|symbol] [asc|desc] [top <n>] [page <n>]");
+                return;
+            }
+        }
+        if (page > 1 && count == std::numeric_limits<size_t>::max()) {
+            count = LIST_PAGE_SIZE;
+        }
+        const bool highest_first = descending.value_or(key != RankKey::Symbol);
+        const size_t offset = (page - 1) * count;
+
+        if (stocks.empty()) {
+            output.line() << "No stocks subscribed.\n";
+            return;
+        }
+
+        // Only the requested page is read from the index
+        RankIndex::page(ranking_views, key, highest_first, offset, count, list_rows);
+        const size_t ranked = RankIndex::size(ranking_views);
+        CurrencySet sources;
+        for (const auto& row : list_rows) {
+            sources.set(row.data.currency);
+        }
+        const FxFactors fx = fx_rates.prepare(display_currency, sources);
+
+        auto out = output.line();
+        if (list_rows.empty()) {
+            out << "No stocks on page " << page << " (" << ranked << " ranked)\n";
+        }
+        else {
+            out << "Subscribed stocks by " << rankKeyName(key) << (highest_first ? ", highest first" : "")
+                << " (" << offset + 1 << "-" << offset + list_rows.size() << " of " << ranked << "):\n";
+        }
+        for (const auto& row : list_rows) {
+            const StockData& data = row.data;
+            out << symbolName(row.key) << ": " << Currencies::prefix(fx.display[data.currency])
+                << fx(data.current_price, data.currency) << " (" << data.change_percent << "% change)";
+            if (key == RankKey::Volume) {
+                out << ", volume " << row.volume;
+            }
+            out << "\n";
+        }
+        const size_t subscribed = stocks.size();
+        if (subscribed > ranked) {
+            out << (subscribed - ranked) << " more subscribed with no quote yet\n";
+        }
     }
 
-    void CliApp::requestPriceHistory(const std::string& symbol) {
-        //spdlog::info("Requesting price history for {}", symbol);
-        Message msg = Message::makeRequestPriceHistory(symbol);
-        publisher.send(msg);
+    void CliApp::watchStocks() {
+        // The presenter thread owns the dashboard; this thread only waits for input
+        {
+            std::lock_guard<std::mutex> lock(presenter_mutex);
+            watching = true;
+        }
+        presenter_cv.notify_all();
+
+        // Any input line returns to the prompt
+        std::string input;
+        std::getline(std::cin, input);
+
+        // Wait until the normal screen is back before printing the prompt again
+        std::unique_lock<std::mutex> lock(presenter_mutex);
+        watching = false;
+        presenter_cv.notify_all();
+        presenter_cv.wait(lock, [this] { return !dashboard_active || !running; });
     }
 
-    void CliApp::listStocks() {
-        if (stocks.empty()) {
-            std::cout << "No stocks subscribed.\n";
+    void CliApp::composeDashboard(FrameBuffer& frame) {
+        // Header takes three rows; the last row reports anything that didn't fit.
+        // Only the rows that fit are read from the index, already in symbol order.
+        const size_t visible = frame.height() > 4 ? frame.height() - 4 : 0;
+        RankIndex::page(ranking_views, RankKey::Symbol, false, 0, visible, dashboard_rows);
+        const size_t ranked = RankIndex::size(ranking_views);
+        const size_t subscribed = stocks.size();
+        const size_t total = std::max(ranked, subscribed);
+
+        // Symbols without a quote yet aren't ranked. Only while there are some is every
+        // subscribed symbol read, to place them in symbol order with a placeholder row.
+        dashboard_symbols.clear();
+        if (ranked < subscribed) {
+            for (const auto& [symbol, data] : stocks.snapshot()) {
+                dashboard_symbols.push_back(symbol);
+            }
+            const size_t shown = std::min(visible, dashboard_symbols.size());
+            std::partial_sort(dashboard_symbols.begin(), dashboard_symbols.begin() + shown, dashboard_symbols.end());
+            dashboard_symbols.resize(shown);
+        }
+
+        CurrencySet sources;
+        for (const auto& entry : dashboard_rows) {
+            sources.set(entry.data.currency);
+        }
+        const FxFactors fx = fx_rates.prepare(display_currency, sources);
+        char line[128];
+        std::snprintf(line, sizeof(line), "TickrShell watch - %zu symbols (press Enter to return)", total);
+        frame.put(0, 0, line);
+        frame.put(2, 0, "SYMBOL   CCY         PRICE     CHANGE");
+
+        size_t row = 3;
+        const auto putRanked = [&](const RankIndex::Row& entry) {
+            const std::string_view symbol = symbolName(entry.key);
+            const StockData& data = entry.data;
+            std::snprintf(line, sizeof(line), "%-8.*s %-4s %12.2f %+9.2f%%",
+                static_cast<int>(symbol.size()), symbol.data(), Currencies::code(fx.display[data.currency]).data(),
+                fx(data.current_price, data.currency), data.change_percent);
+            frame.put(row++, 0, line);
+        };
+        if (dashboard_symbols.empty()) {
+            for (const auto& entry : dashboard_rows) {
+                putRanked(entry);
+            }
         }
         else {
-            std::cout << "Subscribed stocks:\n";
-            for (const auto& [symbol, data] : stocks) {
-                std::cout << symbol << ": $" << data.current_price << " ("
-                    << data.change_percent << "% change)\n";
+            // Both lists are in symbol order; a ranked row for a symbol just unsubscribed is skipped
+            size_t next = 0;
+            for (const auto& symbol : dashboard_symbols) {
+                while (next < dashboard_rows.size() && symbolName(dashboard_rows[next].key) < symbol) {
+                    ++next;
+                }
+                if (next < dashboard_rows.size() && symbolName(dashboard_rows[next].key) == symbol) {
+                    putRanked(dashboard_rows[next++]);
+                    continue;
+                }
+                std::snprintf(line, sizeof(line), "%-8s %-4s %12s %10s", symbol.c_str(), "", "--", "--");
+                frame.put(row++, 0, line);
             }
         }
+        const size_t drawn = row - 3;
+        if (total > drawn) {
+            std::snprintf(line, sizeof(line), "... %zu more", total - drawn);
+            frame.put(row, 0, line);
+        }
     }
 
     void CliApp::showHelp() {
-        std::cout << "Commands:\n"
-            << "  subscribe <symbol>   - Subscribe to stock updates\n"
-            << "  unsubscribe <symbol> - Unsubscribe from stock\n"
-            << "  query <symbol>       - Get current price for a stock\n"
+        output.line() << "Commands:\n"
+            << "  subscribe <symbol>   - Subscribe to stock updates (several symbols allowed)\n"
+            << "  unsubscribe <symbol> - Unsubscribe from stock (several symbols allowed)\n"
+            << "  query <symbol>       - Get current price for a stock (several symbols allowed)\n"
             << "  graph <symbol>       - Show graph view of stock (price history needed) \n"
-            << "  history <symbol>     - Show price history of stock (last 5)\n"
-            << "  list                 - Show all subscribed stocks\n"
+            << "    [points|all]         Ticks to plot, downsampled to the terminal width (default 60)\n"
+            << "    [duration]           Plot a time range from the local tick store, e.g. 15m, 2h\n"
+            << "    [braille]            Draw with Braille dots for 2x4 finer resolution\n"
+            << "  history <symbol>     - Show price history of stock (last 15, stored locally)\n"
+            << "    [duration]           Summarise a time range from the local store, e.g. 15m, 2h\n"
+            << "  stats <symbol>       - Show rolling SMA/EMA, volatility, min/max and VWAP\n"
+            << "  corr [n]             - Most correlated pairs of symbols by recent returns (default 10)\n"
+            << "  corr <symbol> [...]  - One symbol's strongest correlations, or a matrix of several\n"
+            << "  beta <symbol> <index> - Beta and correlation of a symbol's returns to another's\n"
+            << "  list                 - Show all subscribed stocks, by symbol\n"
+            << "    [change|movers|price|volume|symbol] Sort order; numbers highest first\n"
+            << "    [asc|desc] [top <n>] [page <n>]     Direction, rows shown, and which page of them\n"
+            << "  top [n] [key]        - Top movers by size of % change (default 10), or by another key\n"
+            << "  alert <symbol> > <price> - Alert once when the price goes over a level\n"
+            << "    [< | crosses]        Or goes under it, or moves through it (quote currency)\n"
+            << "  alert list|remove <id>|clear - Show or delete alerts\n"
+            << "  watch                - Live dashboard of subscribed stocks (Enter to return)\n"
+            << "  metrics              - Show feed-to-screen latency, message counts and queue depths\n"
             << "  currency <code>      - Set display currency (e.g. EUR, GBP)\n"
             << "  help                 - Show this help\n"
             << "  clear                - Clears the terminal\n"
@@ -263,20 +890,21 @@ namespace StockTracker {
     }
 
     void CliApp::printWelcomeMessage() {
-        std::cout << "=====================================\n";
-        std::cout << "  Welcome to TickrShell   \n";
-        std::cout << "=====================================\n";
-        std::cout << "This program allows you to track stock prices in real time.\n";
-        std::cout << "You can subscribe to stock updates, query the latest prices, or view price history graphs.\n";
-        std::cout << "Type 'help' to see the list of available commands.\n";
-        std::cout << "-------------------------------------\n";
-        std::cout << "Author: Philip Lee\n";
-        std::cout << "-------------------------------------\n";
-        std::cout << "Note: for now, it is only possible to subscribe to MSFT, AAPL, GOOGL, AMZN and META \n";
+        auto out = output.line();
+        out << "=====================================\n";
+        out << "  Welcome to TickrShell   \n";
+        out << "=====================================\n";
+        out << "This program allows you to track stock prices in real time.\n";
+        out << "You can subscribe to stock updates, query the latest prices, or view price history graphs.\n";
+        out << "Type 'help' to see the list of available commands.\n";
+        out << "-------------------------------------\n";
+        out << "Author: Philip Lee\n";
+        out << "-------------------------------------\n";
+        out << "Note: for now, it is only possible to subscribe to MSFT, AAPL, GOOGL, AMZN and META \n";
     }
 
     void CliApp::showUsageCosts() {
-        std::cout << "\nUsage Costs and Information:\n"
+        output.line() << "\nUsage Costs and Information:\n"
             << "==============================\n"
             << "1. Data updates: Updates for subscribed stocks are provided every 8 seconds.\n"
             << "2. API Rate Limits: Maximum 100 queries per minute\n"
@@ -284,45 +912,134 @@ namespace StockTracker {
     }
 
     void CliApp::showSafetyTips() {
-        std::cout << "\nSafety Tips:\n";
-        std::cout << "1. Always verify stock symbols before subscribing\n";
-        std::cout << "2. Use 'query' to check prices before subscribing\n";
-        std::cout << "3. Review 'history' to understand price volatility\n";
-        std::cout << "4. Use 'list' regularly to track your subscriptions\n";
-        std::cout << "5. Clear the screen with 'clear' if it gets cluttered\n\n";
+        auto out = output.line();
+        out << "\nSafety Tips:\n";
+        out << "1. Always verify stock symbols before subscribing\n";
+        out << "2. Use 'query' to check prices before subscribing\n";
+        out << "3. Review 'history' to understand price volatility\n";
+        out << "4. Use 'list' regularly to track your subscriptions\n";
+        out << "5. Clear the screen with 'clear' if it gets cluttered\n\n";
     }
 
 
     void CliApp::clearScreen() {
         // Using ANSI escape codes to clear the screen
-        std::cout << "\033[2J\033[H";  // Clears the screen and moves the cursor to the top-left
-        std::cout.flush();              // Ensures that the output is written immediately
+        output.push("\033[2J\033[H");  // Clears the screen and moves the cursor to the top-left
 
         printWelcomeMessage();
     }
 
 
-    void CliApp::updateStockData(const StockQuote& quote) {
-        auto& data = stocks[quote.symbol];
-        data.current_price = quote.price;
-        data.change_percent = quote.change_percent.value_or(0.0);
-        data.currency = quote.currency;  // Make sure to update the currency
+    bool CliApp::updateStockData(FeedShard& shard, const QuoteTick& tick) {
+        // Updates price, currency and the price history used by the graph
+        const int64_t start = monotonicNs();
+        const SequenceCheck sequence = shard.sequences.check(tick);
+        if (sequence.result == SequenceCheck::Result::Stale) {
+            shard.metrics.stale.add();
+            return true; // Newer data is already applied
+        }
 
-        // Keep a price history for the graph
-        data.price_history.push_back(quote.price);
-        if (data.price_history.size() > StockData::MAX_HISTORY) {
-            data.price_history.pop_front();
+        bool claimed = false;
+        auto data = stocks.apply(tick, shard.index, claimed);
+        if (!data) {
+            shard.sequences.forget(tick.key);
+            return stocks.contains(tick.symbol); // Not subscribed, or published by another feed's shard
+        }
+        if (claimed) {
+            restored_rankings.erase(tick.key); // Ranked by this shard from now on
+        }
+        shard.rankings.update(tick.key, *data, tick.volume);
+        shard.alerts.check(tick.key, tick.price, tick.timestamp_ns, shard.fired_alerts);
+        if (!shard.fired_alerts.empty()) {
+            if (shards.size() > 1) {
+                // The other shards' copies of these alerts can't fire, but 'alert list' shows them
+                std::vector<uint64_t> ids;
+                for (const FiredAlert& fired : shard.fired_alerts) {
+                    ids.push_back(fired.alert.id);
+                }
+                postToShards([ids](FeedShard& other) {
+                    for (uint64_t id : ids) {
+                        other.alerts.remove(id);
+                    }
+                });
+            }
+            // Only contended when an alert fires
+            std::lock_guard<std::mutex> lock(alert_mutex);
+            alert_outbox.insert(alert_outbox.end(), shard.fired_alerts.begin(), shard.fired_alerts.end());
+            shard.fired_alerts.clear();
+        }
+        if (sequence.result == SequenceCheck::Result::Gap) {
+            noteGap(shard, tick, sequence);
+        }
+        if (tick.timestamp_ns > 0) {
+            shard.metrics.feed_age.record(nowNs() - tick.timestamp_ns);
+        }
+
+        if (shard.tick_writer) {
+            shard.tick_writer->append(tick.symbol, tick.timestamp_ns, tick.price, tick.volume);
         }
 
-        // Log the stock update received
-        std::string currencySymbol = (data.currency == "USD") ? "$" : data.currency;
-        std::cout << "Received stock update: " << quote.symbol
-            << " - " << currencySymbol << std::fixed << std::setprecision(2)
-            << data.current_price << " (" << data.change_percent << "% change)\n";
+        // Printed later by the presenter, coalesced with any other ticks for this symbol
+        shard.conflator.push(tick.key, *data, shard.message_received_ns);
+        shard.metrics.quotes.add();
+        shard.metrics.apply.record(monotonicNs() - start);
+        if (tick_observer) {
+            tick_observer(tick);
+        }
+        return true;
+    }
+
+    void CliApp::takeOverRanking(FeedShard& shard, std::string_view symbol) {
+        // The cached row moves to the claiming shard, so the symbol stays listed until its first tick
+        const SymbolKey key = symbolKey(symbol);
+        restored_rankings.erase(key);
+        if (const auto data = stocks.find(symbol)) {
+            shard.rankings.update(key, *data, 0.0);
+        }
+    }
+
+    void CliApp::noteGap(FeedShard& shard, const QuoteTick& tick, const SequenceCheck& check) {
+        shard.metrics.gaps.add();
+        shard.metrics.missed.add(check.missed);
+
+        const int64_t now = monotonicNs();
+        if (PendingResync* pending = shard.resyncs.find(tick.key)) {
+            pending->to_ns = tick.timestamp_ns;
+            pending->missed += check.missed;
+            if (now - pending->requested_ns < std::chrono::nanoseconds(RESYNC_RETRY).count()) {
+                return; // The outstanding request will cover this gap too
+            }
+            pending->requested_ns = now;
+        }
+        else {
+            shard.resyncs.insert(tick.key, { check.gap_from_ns, tick.timestamp_ns, check.missed, now });
+        }
+        shard.resync_requests.emplace_back(tick.symbol);
+    }
+
+    template <typename History>
+    bool CliApp::completeResync(FeedShard& shard, std::string_view symbol, const History& history) {
+        // Returns false for history no resync asked for, which is shown to the user
+        const SymbolKey key = symbolKey(symbol);
+        const PendingResync* pending = shard.resyncs.find(key);
+        if (!pending) {
+            return false;
+        }
+
+        uint64_t found = 0;
+        for (const auto& item : history) {
+            const QuoteTick tick = toTick(item);
+            if (tick.timestamp_ns > pending->from_ns && tick.timestamp_ns < pending->to_ns) {
+                ++found;
+            }
+        }
+        shard.metrics.recovered.add(std::min(found, pending->missed));
+        shard.resyncs.erase(key);
+        return true;
     }
 
     bool CliApp::confirmAction(const std::string& action, const std::string& symbol) {
-        std::cout << "Are you sure you want to " << action << " " << symbol << "? (y/n): ";
+        output.line() << "Are you sure you want to " << action << " " << symbol << "? (y/n): ";
         std::string response;
         std::getline(std::cin, response);
         return (response == "y" || response == "Y");
@@ -331,11 +1048,11 @@ namespace StockTracker {
     bool CliApp::isValidSymbolFormat(const std::string& symbol) {
         // Check if symbol is 1-5 uppercase letters
         if (symbol.empty() || symbol.length() > 5) return false;
-        return std::all_of(symbol.begin(), symbol.end(), [](char c) { return std::isupper(c); });
+        return std::all_of(symbol.begin(), symbol.end(), [](char c) { return std::isupper(static_cast<unsigned char>(c)) != 0; });
     }
 
     bool CliApp::isStockSubscribed(const std::string& symbol) {
-        return stocks.find(symbol) != stocks.end();
+        return stocks.contains(symbol);
     }
 
     void CliApp::setCurrency(const std::string& currency) {
@@ -349,110 +1066,598 @@ namespace StockTracker {
             return;
         }
 
-        display_currency = currency;
+        display_currency = Currencies::intern(currency);
         Message msg = Message::makeSetCurrency(currency);
-        publisher.send(msg);
+        sendRequests({ msg });
         spdlog::info("Requesting currency change to {}", currency);
     }
 
-    void CliApp::displayPriceInCurrency(double price) const {
-        if (display_currency == "USD") {
-            std::cout << "$" << std::fixed << std::setprecision(2) << price;
+    void CliApp::alertCommand(const std::vector<std::string>& args) {
+        // alert <symbol> >|<|crosses <price>, alert list, alert remove <id>, alert clear
+        const char* usage = "Usage: alert <symbol> >|<|crosses <price> | alert list | alert remove <id> | alert clear";
+        // Every shard holds the same alerts until one fires, so shard 0 answers for all
+        if (args.size() == 1 && args[0] == "list") {
+            shards.front()->post([this](FeedShard& shard) {
+                shard.alerts.list(shard.alert_rows);
+                auto out = output.line();
+                out << std::fixed << std::setprecision(2);
+                if (shard.alert_rows.empty()) {
+                    out << "No alerts set.\n";
+                }
+                for (const Alert& alert : shard.alert_rows) {
+                    out << "  #" << alert.id << " " << symbolName(alert.symbol) << " "
+                        << alertConditionName(alert.condition) << " " << alert.threshold << "\n";
+                }
+            });
+            return;
+        }
+        if (args.size() == 1 && args[0] == "clear") {
+            postToShards([this](FeedShard& shard) {
+                const size_t removed = shard.alerts.clear();
+                if (shard.index == 0) {
+                    output.line() << "Removed " << removed << " alerts.\n";
+                }
+            });
+            return;
+        }
+        if (args.size() == 2 && args[0] == "remove") {
+            uint64_t id = 0;
+            try {
+                id = std::stoull(args[1]);
+            }
+            catch (const std::exception&) {
+                spdlog::warn(usage);
+                return;
+            }
+            postToShards([id](FeedShard& shard) {
+                if (!shard.alerts.remove(id) && shard.index == 0) {
+                    spdlog::warn("No alert #{}", id);
+                }
+            });
             return;
         }
 
+        const auto condition = args.size() == 3 ? parseAlertCondition(args[1]) : std::nullopt;
+        if (!condition) {
+            spdlog::warn(usage);
+            return;
+        }
+        if (!isValidSymbolFormat(args[0])) {
+            spdlog::warn("Invalid symbol format: {}. Symbols should be 1-5 uppercase letters.", args[0]);
+            return;
+        }
+        double threshold = 0.0;
         try {
-            double converted = currency_service.convertCurrency(price, display_currency);
-            std::cout << display_currency << " " << std::fixed << std::setprecision(2) << converted;
+            size_t consumed = 0;
+            threshold = std::stod(args[2], &consumed);
+            if (consumed != args[2].size() || !(threshold > 0.0) || !std::isfinite(threshold)) {
+                throw std::invalid_argument(args[2]);
+            }
         }
-        catch (const std::exception& e) {
-            // Fallback to USD if conversion fails
-            std::cout << "$" << std::fixed << std::setprecision(2) << price;
-            spdlog::warn("Currency conversion failed: {}", e.what());
+        catch (const std::exception&) {
+            spdlog::warn("Invalid price: {}", args[2]);
+            return;
         }
+
+        const Alert alert{ next_alert_id++, symbolKey(args[0]), *condition, threshold };
+        if (!isStockSubscribed(args[0])) {
+            spdlog::warn("{} is not subscribed; the alert is checked once it is", args[0]);
+        }
+        postToShards([this, alert](FeedShard& shard) {
+            // The stored price is the starting point for 'crosses'
+            const auto data = stocks.find(symbolName(alert.symbol));
+            shard.alerts.add(alert, data && data->current_price > 0.0 ? std::optional<double>(data->current_price) : std::nullopt);
+        });
+        output.line() << "Alert #" << alert.id << " set: " << args[0] << " "
+            << alertConditionName(alert.condition) << " " << args[2] << "\n";
     }
 
-    void CliApp::processUpdates() {
+    void CliApp::processUpdates(FeedShard& shard) {
+        if (config.pin_workers) {
+            // Core 0 is left to the input, presenter and output threads
+            const size_t cores = coreCount();
+            const size_t core = cores > 1 ? (shard.index + 1) % cores : 0;
+            if (!pinCurrentThread(core)) {
+                spdlog::warn("Could not pin the worker for {} to core {}", shard.endpoint, core);
+            }
+        }
+
+        zmq::pollitem_t items[] = {
+            { static_cast<void*>(shard.subscriber), 0, ZMQ_POLLIN, 0 },
+            { static_cast<void*>(shard.wakeup_receiver), 0, ZMQ_POLLIN, 0 },
+        };
+
         while (running) {
-            // Receive a message from the subscriber
-            if (auto msg = subscriber.receive(true)) {
-                // If we successfully received a message, handle it
-                if (msg->type == MessageType::QuoteUpdate && msg->quote) {
-                    if (isStockSubscribed(msg->quote->symbol)) {
-                        updateStockData(*msg->quote);  // This is for subscribed stocks
-                    }
-                    else {
-                        // This is a one-time query result, display it but don't subscribe
-                        std::cout << "Queried stock: " << msg->quote->symbol
-                            << " - $" << msg->quote->price
-                            << " (" << msg->quote->change_percent.value_or(0.0) << "% change)\n";
+            // Sleep until the feed or another thread has something for us, or a handshake retry is due
+            zmq::poll(items, 2, advanceHandshake(shard));
+
+            if (items[1].revents & ZMQ_POLLIN) {
+                shard.runTasks();
+            }
+
+            if (items[0].revents & ZMQ_POLLIN) {
+                drainUpdates(shard); // Output is queued; the output writer does the terminal I/O
+            }
+        }
+    }
+
+    size_t CliApp::drainUpdates(FeedShard& shard) {
+        // Handle everything already queued, bounded so a wakeup is never starved by a busy feed
+        size_t handled = 0;
+        zmq::message_t first;
+        zmq::message_t payload;
+        zmq::socket_t& subscriber = shard.subscriber;
+        while (handled < MAX_DRAIN_BATCH && subscriber.recv(first, zmq::recv_flags::dontwait)) {
+            ++handled;
+
+            // Messages are [topic][payload]; a lone frame is the payload from a publisher without topics
+            zmq::message_t* body = &first;
+            if (first.more()) {
+                subscriber.recv(payload); // All parts of a message arrive together
+                body = &payload;
+                while (payload.more()) {
+                    zmq::message_t extra;
+                    subscriber.recv(extra); // Unknown trailing parts
+                    if (!extra.more()) {
+                        break;
                     }
                 }
-                else if (msg->type == MessageType::PriceHistoryResponse) {
-                    const auto& history = msg->priceHistory;
-                    if (history) {
-                        auto& data = stocks[msg->symbol];
-                        data.price_history.clear();
-                        for (const auto& quote : *history) {
-                            data.price_history.push_back(quote.price);  // Store only the price in the deque
-                        }
-                        std::cout << "Price history for: " << msg->symbol << "\n";
-                        for (const auto& price : data.price_history) {
-                            std::cout << "  $" << price << "\n";
+            }
+            const zmq::message_t& frame = *body;
+            shard.message_received_ns = monotonicNs();
+            shard.metrics.messages.add();
+
+            // Binary frames are read in place; anything else is JSON
+            if (Wire::FrameView::isBinary(frame.data(), frame.size())) {
+                if (auto view = Wire::FrameView::parse(frame.data(), frame.size())) {
+                    shard.metrics.decode.record(monotonicNs() - shard.message_received_ns);
+                    handleUpdate(shard, *view);
+                }
+                else {
+                    shard.metrics.malformed.add();
+                    spdlog::warn("Dropping malformed binary update ({} bytes)", frame.size());
+                }
+                continue;
+            }
+
+            Message msg;
+            try {
+                msg = Message::deserialize(frame.to_string());
+            }
+            catch (const std::exception& e) {
+                shard.metrics.malformed.add();
+                spdlog::warn("Dropping malformed update: {}", e.what());
+                continue;
+            }
+            shard.metrics.decode.record(monotonicNs() - shard.message_received_ns);
+            handleUpdate(shard, msg);
+        }
+        if (handled > 0) {
+            shard.metrics.drain_batch.set(handled);
+        }
+        if (!shard.resync_requests.empty()) {
+            shard.metrics.resyncs.add(shard.resync_requests.size());
+            requestPriceHistory(shard.resync_requests, false);
+            shard.resync_requests.clear();
+        }
+        return handled;
+    }
+
+    void CliApp::handleUpdate(FeedShard& shard, const Message& msg) {
+        if (msg.type == MessageType::QuoteUpdate && msg.quote) {
+            const QuoteTick tick = toTick(*msg.quote);
+            if (!updateStockData(shard, tick)) {
+                printQueriedQuote(tick);
+            }
+            if (batch) {
+                batch->resolve(MessageType::QuoteUpdate, tick.symbol, BatchReply::fromTick(tick));
+            }
+            return;
+        }
+
+        // Everything below is a reply, queued as one piece of output
+        auto out = updateOutput();
+        if (msg.type == MessageType::PriceHistoryResponse) {
+            const auto& history = msg.priceHistory;
+            if (history) {
+                const bool resync = completeResync(shard, msg.symbol, *history);
+                const bool shown = takeHistoryRequest(symbolKey(msg.symbol)) || !resync;
+                // A reply only to a resync leaves the store alone: the live ticks around the gap
+                // are already there, and the short recent history can't be spliced in between.
+                bool claimed = false;
+                const bool stored = shown && stocks.replaceHistory(msg.symbol, *history, shard.index, claimed);
+                if (claimed) {
+                    takeOverRanking(shard, msg.symbol);
+                }
+                if (batch) {
+                    BatchReply reply = history->empty() ? BatchReply{} : BatchReply::fromTick(toTick(history->back()));
+                    reply.points = history->size();
+                    batch->resolve(MessageType::PriceHistoryResponse, msg.symbol, reply);
+                }
+                if (stored && shard.tick_writer) {
+                    // Only ticks newer than the stored ones; the newest is usually there already
+                    const auto last = tick_store->lastTimestamp(msg.symbol);
+                    for (const auto& quote : *history) {
+                        const QuoteTick tick = toTick(quote);
+                        if (last && tick.timestamp_ns <= *last) {
+                            continue;
                         }
+                        shard.tick_writer->append(msg.symbol, tick.timestamp_ns, tick.price, tick.volume);
                     }
                 }
+                if (shown) {
+                    out << "Price history for: " << msg.symbol << "\n";
+                    for (const auto& quote : *history) {
+                        out << "  $" << quote.price << "\n";
+                    }
+                }
+            }
+        }
 
-                // Handle subscription list from the backend
-                else if (msg->type == MessageType::SubscriptionsList) {
-                    std::vector<std::string> symbolsToQuery;
+        // Handle subscription list from the backend
+        else if (msg.type == MessageType::SubscriptionsList) {
+            const auto& subscriptions = msg.subscriptions.value();
+            std::vector<std::string> added;
 
-                    for (const auto& symbol : msg->subscriptions.value()) {
-                        if (!isStockSubscribed(symbol)) {
-                            stocks[symbol] = StockData{};
-                            std::cout << "Restored subscription to stock: " << symbol << std::endl;
-                            symbolsToQuery.push_back(symbol);
-                        }
+            for (const auto& symbol : subscriptions) {
+                addTopicFilter(shard, symbol);
+                if (!stocks.contains(symbol)) {
+                    out << "Restored subscription to stock: " << symbol << "\n";
+                    added.push_back(symbol);
+                }
+            }
+            stocks.add(added);
+
+            // The service is authoritative: every list, even one arriving after the handshake
+            // gave up, drops cached symbols it no longer has. With several feeds each service
+            // only lists its own symbols, so nothing is dropped.
+            if (shards.size() == 1) {
+                const std::unordered_set<std::string> listed(subscriptions.begin(), subscriptions.end());
+                std::vector<std::string> dropped;
+                for (const auto& [symbol, data] : stocks.snapshot()) {
+                    if (listed.count(symbol) == 0) {
+                        dropped.push_back(symbol);
                     }
+                }
+                stocks.erase(dropped);
+                for (const auto& symbol : dropped) {
+                    restored_rankings.erase(symbolKey(symbol));
+                    removeTopicFilter(shard, symbol);
+                }
+            }
+
+            // The first list refreshes every price, including the ones shown from the cache,
+            // whether or not the handshake already gave up. Later lists only need new symbols.
+            std::vector<std::string> symbolsToQuery = shard.subscriptions_listed ? added : subscriptions;
+            shard.subscriptions_listed = true;
+            settleHandshake(shard);
+
+            // One batched snapshot request. The quotes are applied by the normal update
+            // path as they stream in, so nothing here waits on the DataService.
+            if (!symbolsToQuery.empty()) {
+                query(symbolsToQuery);
+            }
+            out << "Number of subscribed stocks in local cache: " << stocks.size() << "\n";
+            out << "\n> ";
+        }
+        else if (msg.type == MessageType::Subscribe) {
+            // Update the CLI's subscribed stock list
+            addTopicFilter(shard, msg.symbol);
+            if (stocks.add(msg.symbol)) {
+                out << "Subscribed to stock: " << msg.symbol << "\n";
+            }
+            if (batch) {
+                batch->resolve(MessageType::Subscribe, msg.symbol, {});
+            }
+        }
+        else if (msg.type == MessageType::Error && msg.error) {
+            out << "Error: " << *msg.error << "\n";
+            if (batch) {
+                batch->resolveError(msg.symbol, *msg.error);
+            }
+        }
+    }
+
+    void CliApp::presentUpdates() {
+        std::vector<ConflatedQuote> batch;
+        std::vector<ConflatedQuote> shard_batch; // Other shards' entries, appended to batch
+        std::vector<FiredAlert> fired;
+        std::unique_ptr<Dashboard> dashboard;
+        size_t shown_symbols = 0;
+        auto next_present = std::chrono::steady_clock::now();
+
+        std::ofstream metrics_out;
+        if (!config.metrics_file.empty()) {
+            metrics_out.open(config.metrics_file, std::ios::app);
+            if (!metrics_out) {
+                spdlog::warn("Could not open metrics file {}", config.metrics_file);
+            }
+        }
+        const auto metrics_interval = std::chrono::seconds(config.metrics_interval_s);
+        auto next_metrics = std::chrono::steady_clock::now() + metrics_interval;
 
-                    // Query symbols with a delay between each
-                    for (const auto& symbol : symbolsToQuery) {
-                        query(symbol);
-                        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        while (running) {
+            const bool watch = watching;
+            const auto interval = watch
+                ? std::chrono::microseconds(1000000 / config.watch_fps)
+                : std::chrono::microseconds(config.print_interval_ms * 1000);
+            next_present = std::max(next_present + interval, std::chrono::steady_clock::now());
+
+            // Sleep until the next interval, waking early if watch mode is toggled or we are stopping.
+            // A correlation interval shorter than ours still gets one price sample per interval:
+            // we also wake at each sample boundary before the next frame, sample and sleep again.
+            const int64_t sample_ns = static_cast<int64_t>(config.corr_interval_ms) * 1000000;
+            for (;;) {
+                const auto sample_at = std::chrono::steady_clock::now() + std::chrono::nanoseconds(sample_ns - nowNs() % sample_ns);
+                {
+                    std::unique_lock<std::mutex> lock(presenter_mutex);
+                    if (presenter_cv.wait_until(lock, std::min(next_present, sample_at), [&] { return !running || watching != watch; })) {
+                        break;
                     }
-                    std::cout << "Number of subscribed stocks in local cache: " << stocks.size() << "\n";
-                    std::cout << "\n> ";
-                    std::cout.flush();
-                }
-                else if (msg->type == MessageType::Subscribe) {
-                    // Update the CLI's subscribed stock list
-                    if (!isStockSubscribed(msg->symbol)) {
-                        stocks[msg->symbol] = StockData{};
-                        std::cout << "Subscribed to stock: " << msg->symbol << std::endl;
+                }
+                // One price sample per correlation interval; a no-op between them
+                correlations.advance(nowNs());
+                if (std::chrono::steady_clock::now() >= next_present) {
+                    break;
+                }
+            }
+            if (!running) {
+                break;
+            }
+
+            if (watching && !dashboard) {
+                // The dashboard writes to the terminal itself. Other output is held until it is
+                // left, so nothing lands between or inside its frames.
+                output.pause();
+
+                // Leave the last column free so a full row never wraps the terminal
+                const auto size = queryTerminalSize();
+                dashboard = std::make_unique<Dashboard>(size.columns > 1 ? size.columns - 1 : size.columns, size.rows);
+                dashboard->enter();
+                shown_symbols = std::numeric_limits<size_t>::max(); // Force the first frame
+                setDashboardActive(true);
+            }
+            else if (!watching && dashboard) {
+                dashboard->leave();
+                dashboard.reset();
+                output.resume();
+                setDashboardActive(false);
+            }
+
+            // Alerts wait while the dashboard is up and print once it is left
+            if (!dashboard) {
+                {
+                    std::lock_guard<std::mutex> lock(alert_mutex);
+                    fired.swap(alert_outbox);
+                }
+                if (!fired.empty()) {
+                    printAlerts(fired);
+                    fired.clear();
+                }
+            }
+
+            // Shards hold disjoint symbols, so their batches are simply concatenated
+            shards.front()->conflator.drain(batch);
+            for (size_t i = 1; i < shards.size(); ++i) {
+                shards[i]->conflator.drain(shard_batch);
+                batch.insert(batch.end(), shard_batch.begin(), shard_batch.end());
+            }
+            metrics.conflated.set(batch.size());
+            const int64_t render_start = monotonicNs();
+            bool rendered = false;
+            if (dashboard) {
+                // Redraw only when something changed since the last frame
+                if (!batch.empty() || stocks.size() != shown_symbols) {
+                    composeDashboard(dashboard->frame());
+                    dashboard->present();
+                    shown_symbols = stocks.size();
+                    rendered = true;
+                }
+            }
+            else if (!batch.empty()) {
+                printBatch(batch);
+                rendered = true;
+            }
+            if (rendered) {
+                const int64_t shown = monotonicNs();
+                metrics.render.record(shown - render_start);
+                for (const auto& entry : batch) {
+                    metrics.staleness.record(shown - entry.received_ns);
+                }
+            }
+
+            if (metrics_out.is_open() && std::chrono::steady_clock::now() >= next_metrics) {
+                mergedMetrics()->writeJson(metrics_out);
+                metrics_out << "\n";
+                metrics_out.flush();
+                next_metrics += metrics_interval;
+            }
+        }
+
+        if (dashboard) {
+            dashboard->leave();
+            output.resume();
+            setDashboardActive(false);
+        }
+    }
+
+    std::unique_ptr<PipelineMetrics> CliApp::mergedMetrics() const {
+        // On the heap: the histograms are too large for the stack
+        auto merged = std::make_unique<PipelineMetrics>();
+        merged->merge(metrics);
+        for (const auto& shard : shards) {
+            merged->merge(shard->metrics);
+        }
+        return merged;
+    }
+
+    void CliApp::showMetrics() {
+        size_t pending = 0;
+        for (const auto& shard : shards) {
+            pending += shard->conflator.pending();
+        }
+
+        std::ostringstream out;
+        out << "Pipeline metrics since start (latencies in microseconds):\n";
+        mergedMetrics()->writeReport(out);
+        if (shards.size() > 1) {
+            out << "  feeds " << shards.size() << ":";
+            for (const auto& shard : shards) {
+                out << " " << shard->endpoint << " (" << shard->metrics.quotes.load() << " quotes)";
+            }
+            out << "\n";
+        }
+        out << "  subscribed symbols " << stocks.size() << ", presenter pending " << pending << "\n"
+            << "  output pending " << output.pending() << ", output dropped " << output.dropped() << "\n";
+        output.push(out.str());
+    }
+
+    void CliApp::printBatch(const std::vector<ConflatedQuote>& batch) {
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(2);
+        CurrencySet sources;
+        for (const auto& entry : batch) {
+            sources.set(entry.latest.currency);
+        }
+        const FxFactors fx = fx_rates.prepare(display_currency, sources);
+        for (const auto& entry : batch) {
+            const auto& data = entry.latest;
+            out << "Received stock update: " << entry.symbol
+                << " - " << Currencies::prefix(fx.display[data.currency]) << fx(data.current_price, data.currency)
+                << " (" << data.change_percent << "% change)";
+            if (entry.ticks > 1) {
+                out << " [" << entry.ticks << " ticks, low " << fx(entry.low, data.currency)
+                    << ", high " << fx(entry.high, data.currency) << "]";
+            }
+            out << "\n";
+        }
+
+        // One queued write for the whole batch
+        output.push(out.str());
+    }
+
+    void CliApp::printAlerts(const std::vector<FiredAlert>& fired) {
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(2) << '\a'; // Ring the terminal bell once per batch
+        for (const auto& entry : fired) {
+            const Alert& alert = entry.alert;
+            out << "ALERT #" << alert.id << ": " << symbolName(alert.symbol) << " "
+                << alertConditionName(alert.condition) << " " << alert.threshold
+                << ", now " << entry.price << "\n";
+        }
+        output.push(out.str());
+    }
+
+    void CliApp::setDashboardActive(bool active) {
+        {
+            std::lock_guard<std::mutex> lock(presenter_mutex);
+            dashboard_active = active;
+        }
+        presenter_cv.notify_all();
+    }
+
+    void CliApp::handleUpdate(FeedShard& shard, const Wire::FrameView& frame) {
+        if (frame.type() == Wire::RecordType::Quote) {
+            for (const QuoteTick tick : frame) {
+                if (!updateStockData(shard, tick)) {
+                    printQueriedQuote(tick);
+                }
+                if (batch) {
+                    batch->resolve(MessageType::QuoteUpdate, tick.symbol, BatchReply::fromTick(tick));
+                }
+            }
+        }
+        else if (frame.type() == Wire::RecordType::PriceHistory) {
+            const std::string symbol(frame.symbol());
+            const bool resync = completeResync(shard, symbol, frame);
+            const bool shown = takeHistoryRequest(symbolKey(symbol)) || !resync;
+            // A reply only to a resync leaves the store, which already holds the live ticks around the gap
+            bool claimed = false;
+            const bool stored = shown && stocks.replaceHistory(symbol, frame, shard.index, claimed);
+            if (claimed) {
+                takeOverRanking(shard, symbol);
+            }
+            if (batch) {
+                BatchReply reply;
+                size_t points = 0;
+                for (const QuoteTick tick : frame) {
+                    reply = BatchReply::fromTick(tick); // Ends on the newest
+                    ++points;
+                }
+                reply.points = points;
+                batch->resolve(MessageType::PriceHistoryResponse, symbol, reply);
+            }
+            if (stored && shard.tick_writer) {
+                // Only ticks newer than the stored ones; the newest is usually there already
+                const auto last = tick_store->lastTimestamp(symbol);
+                for (const QuoteTick tick : frame) {
+                    if (last && tick.timestamp_ns <= *last) {
+                        continue;
                     }
+                    shard.tick_writer->append(symbol, tick.timestamp_ns, tick.price, tick.volume);
                 }
-                else if (msg->type == MessageType::Error && msg->error) {
-                    std::cout << "Error: " << *msg->error << std::endl;
+            }
+
+            if (shown) {
+                auto out = updateOutput();
+                out << "Price history for: " << symbol << "\n";
+                for (const QuoteTick tick : frame) {
+                    out << "  $" << tick.price << "\n";
                 }
-                std::cout.flush();
             }
+        }
+    }
 
-            // Wait a bit before checking again
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    void CliApp::printQueriedQuote(const QuoteTick& tick) {
+        // This is a one-time query result, display it but don't subscribe
+        updateOutput() << "Queried stock: " << tick.symbol
+            << " - $" << tick.price
+            << " (" << tick.change_percent << "% change)\n";
+    }
+
+    OutputQueue::Line CliApp::updateOutput() {
+        return OutputQueue::Line(watching || batch ? nullptr : &output);
+    }
+
+    void CliApp::postToShards(std::function<void(FeedShard&)> task) {
+        for (auto& shard : shards) {
+            shard->post(task);
+        }
+    }
+
+    void CliApp::addTopicFilter(FeedShard& shard, const std::string& symbol) {
+        // ZMQ counts duplicate subscriptions, so only subscribe once per symbol
+        if (config.topic_filtering && shard.topic_filters.insert(symbol).second) {
+            shard.subscriber.set(zmq::sockopt::subscribe, Topics::quote(symbol));
         }
     }
 
+    void CliApp::removeTopicFilter(FeedShard& shard, const std::string& symbol) {
+        if (shard.topic_filters.erase(symbol) > 0) {
+            shard.subscriber.set(zmq::sockopt::unsubscribe, Topics::quote(symbol));
+        }
+        // Its sequence restarts from whatever the feed is at if it is subscribed again
+        shard.sequences.forget(symbolKey(symbol));
+        shard.resyncs.erase(symbolKey(symbol));
+        shard.rankings.erase(symbolKey(symbol));
+        shard.alerts.forgetPrice(symbolKey(symbol));
+    }
+
     // Minor issue here with incomplete commands. If user is interrupted when an update happens
     // their previous input wont be cleared.
     void CliApp::run() {
-        std::thread update_thread(&CliApp::processUpdates, this);
+        start();
+
+        // First screen comes from the cache; the handshake reconciles it in the background
+        if (!stocks.empty()) {
+            listStocks({}, RankKey::Symbol, std::numeric_limits<size_t>::max());
+        }
 
         // Main CLI loop with input buffering
         std::string input;
         while (running) {
             // Clear any pending input
-            std::cout << "\n> ";
-            std::cout.flush();  // Make sure prompt is displayed
+            output.push("\n> ");
 
             if (std::getline(std::cin, input)) {
                 if (!input.empty()) {
@@ -461,12 +1666,161 @@ namespace StockTracker {
             }
         }
 
-        if (update_thread.joinable()) {
-            update_thread.join();
+        joinThreads();
+
+        if (!config.cache_path.empty() && !SnapshotCache::save(config.cache_path, stocks.snapshot())) {
+            spdlog::warn("Could not write cache {}", config.cache_path);
+        }
+    }
+
+    int CliApp::runBatch(std::istream& input) {
+        // Results are the only thing on stdout; log lines go to stderr so they don't mix in
+        const auto previous_logger = spdlog::default_logger();
+        auto logger = std::make_shared<spdlog::logger>(previous_logger->name(), std::make_shared<spdlog::sinks::stderr_sink_mt>());
+        logger->set_level(previous_logger->level());
+        spdlog::set_default_logger(logger);
+
+        batch = std::make_unique<BatchSession>(output, config.batch_json ? BatchFormat::JsonLines : BatchFormat::Csv);
+        startWorkers(); // No presenter: ticks aren't printed
+
+        // PUB/SUB drops requests sent before the connection is up, so wait for every handshake
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(config.batch_deadline_s);
+        while (settled_shards < shards.size() && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+
+        // Every request goes out as soon as it is read; replies are matched as they arrive
+        std::string line;
+        while (std::getline(input, line)) {
+            const size_t start = line.find_first_not_of(" \t\r");
+            if (start != std::string::npos && line[start] != '#') {
+                runBatchCommand(line);
+            }
+        }
+
+        const bool succeeded = batch->finish(deadline);
+        stop();
+        joinThreads();
+        output.waitUntilWritten();
+        spdlog::set_default_logger(previous_logger);
+        return succeeded ? 0 : 1;
+    }
+
+    void CliApp::runBatchCommand(const std::string& line) {
+        std::istringstream iss(line);
+        std::string command;
+        iss >> command;
+        std::vector<std::string> symbols;
+        for (std::string word; iss >> word;) {
+            symbols.push_back(word);
+        }
+
+        BatchReply failure;
+        const auto command_hash = hash(command.c_str());
+        if (command_hash == Commands::List) {
+            for (const auto& [symbol, data] : stocks.snapshot()) {
+                BatchReply reply;
+                reply.price = data.current_price;
+                reply.change_percent = data.change_percent;
+                reply.currency = std::string(data.currencyCode());
+                batch->complete(command, symbol, reply);
+            }
+            return;
+        }
+
+        // The reply each request waits for; unsubscribe has none
+        std::optional<MessageType> reply_type;
+        switch (command_hash) {
+        case Commands::Query: reply_type = MessageType::QuoteUpdate; break;
+        case Commands::History: reply_type = MessageType::PriceHistoryResponse; break;
+        case Commands::Subscribe: reply_type = MessageType::Subscribe; break;
+        case Commands::Unsubscribe: break;
+        default:
+            failure.status = "error: not available in batch mode";
+            batch->complete(command, "", failure);
+            return;
+        }
+        if (symbols.empty()) {
+            failure.status = "error: no symbol";
+            batch->complete(command, "", failure);
+            return;
+        }
+
+        std::vector<std::string> valid;
+        for (const auto& symbol : symbols) {
+            if (isValidSymbolFormat(symbol)) {
+                valid.push_back(symbol);
+            }
+            else {
+                failure.status = "error: invalid symbol";
+                batch->complete(command, symbol, failure);
+            }
+        }
+        if (valid.empty()) {
+            return;
+        }
+
+        if (!reply_type) {
+            unsubscribe(valid);
+            BatchReply sent;
+            sent.status = "sent";
+            for (const auto& symbol : valid) {
+                batch->complete(command, symbol, sent);
+            }
+            return;
+        }
+
+        // Registered before sending, so even an immediate reply finds its request
+        for (const auto& symbol : valid) {
+            batch->expect(command, symbol, *reply_type, requestFanout(symbol));
+        }
+        switch (command_hash) {
+        case Commands::Query: query(valid); break;
+        case Commands::History: requestPriceHistory(valid); break;
+        case Commands::Subscribe: subscribe(valid); break;
+        }
+    }
+
+    void CliApp::start() {
+        startWorkers();
+        presenter_thread = std::thread(&CliApp::presentUpdates, this);
+    }
+
+    void CliApp::startWorkers() {
+        for (auto& shard : shards) {
+            shard->worker = std::thread(&CliApp::processUpdates, this, std::ref(*shard));
         }
     }
 
     void CliApp::stop() {
-        running = false;
+        {
+            std::lock_guard<std::mutex> lock(presenter_mutex);
+            running = false;
+        }
+        presenter_cv.notify_all();
+        for (auto& shard : shards) {
+            shard->wake(); // Don't wait for the next feed message to notice
+        }
+    }
+
+    void CliApp::joinThreads() {
+        for (auto& shard : shards) {
+            if (shard->worker.joinable()) {
+                shard->worker.join();
+            }
+        }
+        if (presenter_thread.joinable()) {
+            presenter_thread.join();
+        }
+    }
+
+    void CliApp::setTickObserver(std::function<void(const QuoteTick&)> observer) {
+        tick_observer = std::move(observer);
+    }
+
+    CliApp::~CliApp() {
+        // Headless apps are only ever stopped, never run(), so their threads end here
+        stop();
+        joinThreads();
     }
 }
@@ -0,0 +1,158 @@
+#include "CliConfig.h"
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+
+namespace StockTracker {
+    namespace {
+        // Returns the value following an option, e.g. "--history-depth 4096".
+        std::string optionValue(int argc, char* argv[], int& i) {
+            if (i + 1 >= argc) {
+                throw std::invalid_argument(std::string("Missing value for ") + argv[i]);
+            }
+            return argv[++i];
+        }
+
+        // Zero is rejected unless the option gives it a meaning, such as "no limit"
+        size_t parseCount(const std::string& option, const std::string& value, bool allow_zero = false) {
+            try {
+                size_t consumed = 0;
+                const unsigned long long parsed = std::stoull(value, &consumed);
+                if (consumed != value.size() || (parsed == 0 && !allow_zero)) {
+                    throw std::invalid_argument(value);
+                }
+                return static_cast<size_t>(parsed);
+            }
+            catch (const std::exception&) {
+                throw std::invalid_argument("Invalid value for " + option + ": " + value);
+            }
+        }
+    }
+
+    CliConfig CliConfig::fromArgs(int argc, char* argv[]) {
+        CliConfig config;
+        bool default_feed = true; // The first --feed-endpoint replaces the default, later ones add to it
+        bool default_request = true; // Likewise for --request-endpoint
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            if (arg == "--history-depth") {
+                config.history_depth = parseCount(arg, optionValue(argc, argv, i));
+            }
+            else if (arg == "--watch-fps") {
+                config.watch_fps = parseCount(arg, optionValue(argc, argv, i));
+            }
+            else if (arg == "--print-interval") {
+                config.print_interval_ms = parseCount(arg, optionValue(argc, argv, i));
+            }
+            else if (arg == "--topic-filter") {
+                config.topic_filtering = true;
+            }
+            else if (arg == "--connect-attempts") {
+                config.connect_attempts = parseCount(arg, optionValue(argc, argv, i));
+            }
+            else if (arg == "--cache") {
+                config.cache_path = optionValue(argc, argv, i);
+            }
+            else if (arg == "--no-cache") {
+                config.cache_path.clear();
+            }
+            else if (arg == "--fx-ttl") {
+                config.fx_ttl_s = parseCount(arg, optionValue(argc, argv, i));
+            }
+            else if (arg == "--tick-dir") {
+                config.tick_dir = optionValue(argc, argv, i);
+            }
+            else if (arg == "--no-tick-store") {
+                config.tick_dir.clear();
+            }
+            else if (arg == "--tick-retention") {
+                config.tick_retention_h = parseCount(arg, optionValue(argc, argv, i), true);
+            }
+            else if (arg == "--request-endpoint") {
+                if (default_request) {
+                    config.request_endpoints.clear();
+                    default_request = false;
+                }
+                config.request_endpoints.push_back(optionValue(argc, argv, i));
+            }
+            else if (arg == "--feed-endpoint") {
+                if (default_feed) {
+                    config.feed_endpoints.clear();
+                    default_feed = false;
+                }
+                config.feed_endpoints.push_back(optionValue(argc, argv, i));
+            }
+            else if (arg == "--pin-workers") {
+                config.pin_workers = true;
+            }
+            else if (arg == "--receive-hwm") {
+                config.receive_hwm = parseCount(arg, optionValue(argc, argv, i), true);
+            }
+            else if (arg == "--metrics-file") {
+                config.metrics_file = optionValue(argc, argv, i);
+            }
+            else if (arg == "--metrics-interval") {
+                config.metrics_interval_s = parseCount(arg, optionValue(argc, argv, i));
+            }
+            else if (arg == "--corr-interval") {
+                config.corr_interval_ms = parseCount(arg, optionValue(argc, argv, i));
+            }
+            else if (arg == "--corr-window") {
+                config.corr_window = std::max<size_t>(2, parseCount(arg, optionValue(argc, argv, i)));
+            }
+            else if (arg == "--batch") {
+                config.batch = true;
+            }
+            else if (arg == "--script") {
+                config.batch = true;
+                config.script_path = optionValue(argc, argv, i);
+            }
+            else if (arg == "--format") {
+                const std::string format = optionValue(argc, argv, i);
+                if (format != "csv" && format != "json") {
+                    throw std::invalid_argument("Invalid value for --format: " + format);
+                }
+                config.batch_json = format == "json";
+            }
+            else if (arg == "--deadline") {
+                config.batch_deadline_s = parseCount(arg, optionValue(argc, argv, i));
+            }
+            else {
+                throw std::invalid_argument("Unknown option: " + arg);
+            }
+        }
+        if (config.request_endpoints.size() != 1 && config.request_endpoints.size() != config.feed_endpoints.size()) {
+            throw std::invalid_argument("Give one --request-endpoint, or one per --feed-endpoint");
+        }
+        return config;
+    }
+
+    void CliConfig::printUsage(const std::string& program) {
+        std::cout << "Usage: " << program << " [options]\n"
+            << "  --history-depth <n>  Ticks kept in memory per symbol (default 2048)\n"
+            << "  --watch-fps <n>      Frame rate cap for the watch dashboard (default 20)\n"
+            << "  --print-interval <ms> How often coalesced updates are printed (default 100)\n"
+            << "  --topic-filter       Receive only subscribed symbols' topics; the publisher must send topics\n"
+            << "  --connect-attempts <n> Handshake attempts before running without the DataService (default 10)\n"
+            << "  --cache <path>       Subscription and price snapshot file (default tickrshell_cache.json)\n"
+            << "  --no-cache           Don't load or save the snapshot\n"
+            << "  --fx-ttl <seconds>   How long FX rates are cached (default 300)\n"
+            << "  --tick-dir <path>    Where received ticks are stored for local history (default ticks)\n"
+            << "  --no-tick-store      Don't store ticks; 'history' always asks the DataService\n"
+            << "  --tick-retention <hours> Age after which stored ticks are dropped, 0 for never (default 168)\n"
+            << "  --request-endpoint <ep> ZMQ endpoint requests are published on (default tcp://*:5557);\n"
+            << "                       repeat once per feed to send each service only its own symbols' requests\n"
+            << "  --feed-endpoint <ep> ZMQ endpoint of a DataService feed; repeat for several (default tcp://localhost:5556)\n"
+            << "  --pin-workers        Pin each feed's worker thread to its own CPU core\n"
+            << "  --receive-hwm <n>    Feed messages queued before ZMQ drops them, 0 for no limit (default 1000)\n"
+            << "  --metrics-file <path> Append pipeline latency metrics to a file as JSON lines\n"
+            << "  --metrics-interval <seconds> How often the metrics file is written (default 10)\n"
+            << "  --corr-interval <ms> How often prices are sampled for 'corr' and 'beta' (default 1000)\n"
+            << "  --corr-window <n>    Sampled returns 'corr' and 'beta' use per symbol (default 120)\n"
+            << "  --batch              Read commands from stdin without prompts and print results, then exit\n"
+            << "  --script <path>      Like --batch, reading commands from a file\n"
+            << "  --format <csv|json>  Batch result format: CSV or JSON lines (default csv)\n"
+            << "  --deadline <seconds> How long a batch run waits for outstanding replies (default 30)\n";
+    }
+}
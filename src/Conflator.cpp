@@ -0,0 +1,40 @@
+#include "Conflator.h"
+#include <algorithm>
+
+
+namespace StockTracker {
+
+    void Conflator::push(SymbolKey symbol, const StockData& data, int64_t received_ns) {
+        std::lock_guard<std::mutex> lock(mutex);
+        const size_t* position = index.find(symbol);
+        if (!position) {
+            index.insert(symbol, entries.size());
+            ConflatedQuote& entry = entries.emplace_back();
+            entry.symbol = symbolName(symbol);
+            entry.latest = data;
+            entry.ticks = 1;
+            entry.high = entry.low = data.current_price;
+            entry.received_ns = received_ns;
+            return;
+        }
+
+        ConflatedQuote& entry = entries[*position];
+        entry.latest = data;
+        ++entry.ticks;
+        entry.high = std::max(entry.high, data.current_price);
+        entry.low = std::min(entry.low, data.current_price);
+        entry.received_ns = received_ns;
+    }
+
+    void Conflator::drain(std::vector<ConflatedQuote>& batch) {
+        batch.clear();
+        std::lock_guard<std::mutex> lock(mutex);
+        batch.swap(entries);
+        index.clear();
+    }
+
+    size_t Conflator::pending() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return entries.size();
+    }
+}
@@ -0,0 +1,282 @@
+#include "CorrelationMatrix.h"
+#include "ThreadAffinity.h"
+#include <algorithm>
+#include <cmath>
+
+
+namespace StockTracker {
+    namespace {
+        double logReturn(double from, double to) {
+            return from > 0.0 && to > 0.0 ? std::log(to / from) : 0.0;
+        }
+    }
+
+    CorrelationMatrix::CorrelationMatrix(const QuoteStore& stocks, int64_t bucket_ns, size_t window,
+        const VectorKernels& kernels, size_t threads, std::optional<size_t> first_core)
+        : stocks(stocks)
+        , bucket_ns(std::max<int64_t>(1, bucket_ns))
+        , length(std::max<size_t>(2, window))
+        , stride((length + 3) & ~size_t{ 3 })
+        , kernels(kernels)
+        , threads(threads > 0 ? threads : coreCount())
+        , first_core(first_core)
+    {
+    }
+
+    void CorrelationMatrix::advance(int64_t now_ns) {
+        const int64_t bucket = now_ns / bucket_ns;
+        std::lock_guard<std::mutex> lock(mutex);
+        if (last_bucket != NO_BUCKET && bucket <= last_bucket) {
+            return;
+        }
+
+        const Prices prices = stocks.snapshot();
+        if (last_bucket == NO_BUCKET || !sameSymbols(prices)) {
+            reindex(prices, bucket);
+            last_bucket = bucket;
+            return;
+        }
+
+        const size_t n = keys.size();
+        latest.assign(n, 0.0);
+        for (const auto& [symbol, data] : prices) {
+            const size_t row = *rows_by_symbol.find(symbolKey(symbol));
+            latest[row] = logReturn(last_prices[row], data.current_price);
+            if (data.current_price > 0.0) {
+                last_prices[row] = data.current_price;
+            }
+        }
+
+        // Buckets the presenter slept through get no return; the whole move lands in this one
+        const int64_t elapsed = bucket - last_bucket;
+        since_rebuild += static_cast<size_t>(std::min<int64_t>(elapsed, static_cast<int64_t>(length)));
+        const bool full = since_rebuild >= length;
+        const int64_t first = std::max(last_bucket + 1, bucket - static_cast<int64_t>(length) + 1);
+        for (int64_t k = first; k <= bucket; ++k) {
+            const size_t slot = slotOf(k);
+            added.assign(n, 0.0);
+            if (k == bucket) {
+                added = latest;
+            }
+            removed.resize(n);
+            for (size_t row = 0; row < n; ++row) {
+                double& value = returns[row * stride + slot];
+                removed[row] = value;
+                value = added[row];
+            }
+            if (!full) {
+                addColumn(added, removed);
+            }
+        }
+        if (full) {
+            rebuild();
+        }
+        last_bucket = bucket;
+    }
+
+    bool CorrelationMatrix::sameSymbols(const Prices& prices) const {
+        size_t found = 0;
+        for (const auto& [symbol, data] : prices) {
+            const SymbolKey key = symbolKey(symbol);
+            if (key == NO_SYMBOL) {
+                continue;
+            }
+            if (!rows_by_symbol.find(key)) {
+                return false;
+            }
+            ++found;
+        }
+        return found == keys.size();
+    }
+
+    void CorrelationMatrix::reindex(const Prices& prices, int64_t bucket) {
+        keys.clear();
+        rows_by_symbol.clear();
+        for (const auto& [symbol, data] : prices) {
+            const SymbolKey key = symbolKey(symbol);
+            if (key != NO_SYMBOL && rows_by_symbol.insert(key, keys.size())) {
+                keys.push_back(key);
+            }
+        }
+
+        const size_t n = keys.size();
+        returns.assign(n * stride, 0.0);
+        last_prices.assign(n, 0.0);
+        for (const auto& [symbol, data] : prices) {
+            if (const size_t* row = rows_by_symbol.find(symbolKey(symbol))) {
+                backfill(*row, symbol, data.current_price, bucket);
+            }
+        }
+        rebuild();
+    }
+
+    void CorrelationMatrix::backfill(size_t row, const std::string& symbol, double current_price, int64_t bucket) {
+        // A bucket's price is the last tick before it started, and the current price for this one
+        stocks.copyHistory(symbol, series);
+        double* out = &returns[row * stride];
+        const int64_t first = bucket - static_cast<int64_t>(length);
+        double previous = 0.0;
+        size_t next = 0;
+        for (int64_t k = first; k <= bucket; ++k) {
+            double price = current_price;
+            if (k < bucket) {
+                const int64_t start_ns = k * bucket_ns;
+                while (next < series.size() && series.timestamps[next] <= start_ns) {
+                    ++next;
+                }
+                price = next > 0 ? series.prices[next - 1] : 0.0;
+            }
+            if (k > first) {
+                out[slotOf(k)] = logReturn(previous, price);
+            }
+            previous = price;
+        }
+        last_prices[row] = current_price;
+    }
+
+    void CorrelationMatrix::rebuild() {
+        const size_t n = keys.size();
+        sums.assign(n, 0.0);
+        for (size_t row = 0; row < n; ++row) {
+            const double* values = &returns[row * stride];
+            for (size_t i = 0; i < length; ++i) {
+                sums[row] += values[i];
+            }
+        }
+        products.assign(n * n, 0.0);
+        if (!pool && threads > 1 && n > ROW_BLOCK) {
+            pool = std::make_unique<WorkerPool>(threads - 1, first_core);
+        }
+        gram(returns.data(), n, stride, products.data(), kernels, pool.get());
+        since_rebuild = 0;
+    }
+
+    void CorrelationMatrix::addColumn(const std::vector<double>& added, const std::vector<double>& removed) {
+        // Row i of the upper triangle gains added[i] * added[j] and loses removed[i] * removed[j]
+        const size_t n = keys.size();
+        for (size_t i = 0; i < n; ++i) {
+            sums[i] += added[i] - removed[i];
+            if (added[i] != 0.0 || removed[i] != 0.0) {
+                kernels.update(&products[i * n + i], added[i], &added[i], removed[i], &removed[i], n - i);
+            }
+        }
+    }
+
+    void CorrelationMatrix::gram(const double* rows, size_t count, size_t stride, double* out,
+        const VectorKernels& kernels, WorkerPool* pool)
+    {
+        // Each block of rows stays in cache while every later row streams past it once.
+        // Blocks are taken in order, largest first, so the shrinking rows of the triangle
+        // even out across the threads.
+        const size_t blocks = (count + ROW_BLOCK - 1) / ROW_BLOCK;
+        auto work = [&](size_t block) {
+            const size_t begin = block * ROW_BLOCK;
+            const size_t end = std::min(count, begin + ROW_BLOCK);
+            for (size_t j = begin; j < count; ++j) {
+                const double* other = rows + j * stride;
+                for (size_t i = begin; i < end && i <= j; ++i) {
+                    out[i * count + j] = kernels.dot(rows + i * stride, other, stride);
+                }
+            }
+        };
+
+        if (pool) {
+            pool->run(blocks, work);
+        }
+        else {
+            for (size_t block = 0; block < blocks; ++block) {
+                work(block);
+            }
+        }
+    }
+
+    size_t CorrelationMatrix::slotOf(int64_t bucket) const {
+        const int64_t n = static_cast<int64_t>(length);
+        return static_cast<size_t>((bucket % n + n) % n);
+    }
+
+    double CorrelationMatrix::cross(size_t i, size_t j) const {
+        const size_t n = keys.size();
+        const double product = i <= j ? products[i * n + j] : products[j * n + i];
+        return static_cast<double>(length) * product - sums[i] * sums[j];
+    }
+
+    std::optional<double> CorrelationMatrix::correlationAt(size_t i, size_t j) const {
+        const double scale = static_cast<double>(length) * static_cast<double>(length);
+        const double var_i = cross(i, i);
+        const double var_j = cross(j, j);
+        if (!(var_i > MIN_VARIANCE * scale) || !(var_j > MIN_VARIANCE * scale)) {
+            return std::nullopt;
+        }
+        return std::clamp(cross(i, j) / std::sqrt(var_i * var_j), -1.0, 1.0);
+    }
+
+    std::optional<double> CorrelationMatrix::correlation(SymbolKey a, SymbolKey b) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        const size_t* i = rows_by_symbol.find(a);
+        const size_t* j = rows_by_symbol.find(b);
+        if (!i || !j) {
+            return std::nullopt;
+        }
+        return correlationAt(*i, *j);
+    }
+
+    std::optional<double> CorrelationMatrix::beta(SymbolKey symbol, SymbolKey index) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        const size_t* i = rows_by_symbol.find(symbol);
+        const size_t* j = rows_by_symbol.find(index);
+        if (!i || !j) {
+            return std::nullopt;
+        }
+        const double variance = cross(*j, *j);
+        if (!(variance > MIN_VARIANCE * static_cast<double>(length) * static_cast<double>(length))) {
+            return std::nullopt;
+        }
+        return cross(*i, *j) / variance;
+    }
+
+    void CorrelationMatrix::strongest(size_t count, SymbolKey symbol, std::vector<Pair>& out) const {
+        // A heap of the best so far with the weakest on top, so most pairs are one comparison
+        out.clear();
+        auto stronger = [](const Pair& a, const Pair& b) { return std::abs(a.correlation) > std::abs(b.correlation); };
+        std::lock_guard<std::mutex> lock(mutex);
+        auto consider = [&](size_t i, size_t j) {
+            const auto value = correlationAt(i, j);
+            if (!value || count == 0) {
+                return;
+            }
+            if (out.size() == count) {
+                if (std::abs(*value) <= std::abs(out.front().correlation)) {
+                    return;
+                }
+                std::pop_heap(out.begin(), out.end(), stronger);
+                out.pop_back();
+            }
+            out.push_back({ keys[i], keys[j], *value });
+            std::push_heap(out.begin(), out.end(), stronger);
+        };
+
+        const size_t n = keys.size();
+        if (symbol != NO_SYMBOL) {
+            const size_t* row = rows_by_symbol.find(symbol);
+            for (size_t j = 0; row && j < n; ++j) {
+                if (j != *row) {
+                    consider(*row, j);
+                }
+            }
+        }
+        else {
+            for (size_t i = 0; i < n; ++i) {
+                for (size_t j = i + 1; j < n; ++j) {
+                    consider(i, j);
+                }
+            }
+        }
+        std::sort_heap(out.begin(), out.end(), stronger);
+    }
+
+    size_t CorrelationMatrix::size() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return keys.size();
+    }
+}
@@ -0,0 +1,113 @@
+#include "Currency.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <optional>
+
+
+namespace StockTracker::Currencies {
+    namespace {
+        struct Entry {
+            char code[4]{};
+            char prefix[8]{};
+        };
+
+        // Entries are written before `used` publishes them and never change afterwards
+        struct Table {
+            std::array<Entry, MAX> entries;
+            std::array<std::atomic<uint32_t>, MAX> packed{};
+            std::atomic<size_t> used{ 0 };
+            std::mutex writer_mutex;
+
+            Table() {
+                // Well-known codes keep fixed ids. Symbols are UTF-8, which the console is set to
+                // by enableUtf8Output; u8 keeps them UTF-8 in builds without /utf-8.
+                add("USD", "$");
+                add("EUR", u8"\u20AC");
+                add("GBP", u8"\u00A3");
+                add("JPY", u8"\u00A5");
+                entries[UNKNOWN] = make("XXX", nullptr);
+                packed[UNKNOWN].store(pack("XXX"), std::memory_order_relaxed);
+            }
+
+            static uint32_t pack(std::string_view code) {
+                uint32_t value = 0;
+                std::memcpy(&value, code.data(), std::min<size_t>(code.size(), 3));
+                return value;
+            }
+
+            static Entry make(std::string_view code, const char* prefix) {
+                Entry entry;
+                std::memcpy(entry.code, code.data(), std::min<size_t>(code.size(), 3));
+                if (prefix) {
+                    std::strncpy(entry.prefix, prefix, sizeof(entry.prefix) - 1);
+                }
+                else {
+                    std::memcpy(entry.prefix, entry.code, 3);
+                    entry.prefix[3] = ' ';
+                }
+                return entry;
+            }
+
+            CurrencyId add(std::string_view code, const char* prefix) {
+                const size_t id = used.load(std::memory_order_relaxed);
+                entries[id] = make(code, prefix);
+                packed[id].store(pack(code), std::memory_order_relaxed);
+                used.store(id + 1, std::memory_order_release);
+                return static_cast<CurrencyId>(id);
+            }
+
+            std::optional<CurrencyId> find(uint32_t key) const {
+                const size_t count = used.load(std::memory_order_acquire);
+                for (size_t i = 0; i < count; ++i) {
+                    if (packed[i].load(std::memory_order_relaxed) == key) {
+                        return static_cast<CurrencyId>(i);
+                    }
+                }
+                return std::nullopt;
+            }
+        };
+
+        Table& table() {
+            static Table instance;
+            return instance;
+        }
+    }
+
+    CurrencyId intern(std::string_view code) {
+        if (code.empty() || code.size() > 3) {
+            return UNKNOWN;
+        }
+        Table& currencies = table();
+        const uint32_t key = Table::pack(code);
+        if (key == Table::pack("XXX")) {
+            return UNKNOWN;
+        }
+        if (auto id = currencies.find(key)) {
+            return *id;
+        }
+
+        std::lock_guard<std::mutex> lock(currencies.writer_mutex);
+        if (auto id = currencies.find(key)) {
+            return *id;
+        }
+        if (currencies.used.load(std::memory_order_relaxed) == UNKNOWN) {
+            return UNKNOWN;
+        }
+        return currencies.add(code, nullptr);
+    }
+
+    std::string_view code(CurrencyId id) {
+        return table().entries[id < MAX ? id : UNKNOWN].code;
+    }
+
+    std::string_view prefix(CurrencyId id) {
+        return table().entries[id < MAX ? id : UNKNOWN].prefix;
+    }
+
+    size_t count() {
+        return table().used.load(std::memory_order_acquire);
+    }
+}
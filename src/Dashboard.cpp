@@ -0,0 +1,104 @@
+#include "Dashboard.h"
+#include <algorithm>
+#include <iostream>
+#include <utility>
+
+
+namespace StockTracker {
+
+    FrameBuffer::FrameBuffer(size_t width, size_t height)
+        : columns(width)
+        , rows(height)
+        , cells(width * height, ' ')
+    {
+    }
+
+    void FrameBuffer::clear() {
+        std::fill(cells.begin(), cells.end(), ' ');
+    }
+
+    void FrameBuffer::put(size_t row, size_t col, std::string_view text) {
+        if (row >= rows || col >= columns) {
+            return;
+        }
+        const size_t count = std::min(text.size(), columns - col);
+        std::copy_n(text.begin(), count, cells.begin() + row * columns + col);
+    }
+
+    Dashboard::Dashboard(size_t width, size_t height)
+        : front(width, height)
+        , back(width, height)
+    {
+        output.reserve(width * height * 2);
+    }
+
+    void Dashboard::enter() {
+        std::cout << "\033[?1049h\033[?25l";
+        std::cout.flush();
+        full_redraw = true;
+    }
+
+    void Dashboard::leave() {
+        std::cout << "\033[?25h\033[?1049l";
+        std::cout.flush();
+    }
+
+    size_t Dashboard::present() {
+        output.clear();
+        const size_t width = back.width();
+
+        if (full_redraw) {
+            output += "\033[H\033[2J";
+            for (size_t r = 0; r < back.height(); ++r) {
+                moveTo(r, 0);
+                output.append(back.row(r), width);
+            }
+            full_redraw = false;
+        }
+        else {
+            for (size_t r = 0; r < back.height(); ++r) {
+                const char* next = back.row(r);
+                const char* shown = front.row(r);
+
+                size_t c = 0;
+                while (c < width) {
+                    if (next[c] == shown[c]) {
+                        ++c;
+                        continue;
+                    }
+
+                    // Extend the run over short stretches of unchanged cells
+                    size_t end = c + 1;
+                    size_t last_changed = c;
+                    while (end < width && end - last_changed <= MERGE_GAP) {
+                        if (next[end] != shown[end]) {
+                            last_changed = end;
+                        }
+                        ++end;
+                    }
+
+                    moveTo(r, c);
+                    output.append(next + c, last_changed + 1 - c);
+                    c = last_changed + 1;
+                }
+            }
+        }
+
+        if (!output.empty()) {
+            std::cout.write(output.data(), static_cast<std::streamsize>(output.size()));
+            std::cout.flush();
+        }
+
+        std::swap(front, back);
+        back.clear();
+        return output.size();
+    }
+
+    void Dashboard::moveTo(size_t row, size_t col) {
+        output += "\033[";
+        output += std::to_string(row + 1);
+        output += ';';
+        output += std::to_string(col + 1);
+        output += 'H';
+    }
+}
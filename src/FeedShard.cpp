@@ -0,0 +1,53 @@
+#include "FeedShard.h"
+
+
+namespace StockTracker {
+
+    FeedShard::FeedShard(zmq::context_t& context, uint32_t index, const std::string& endpoint, size_t receive_hwm,
+        const std::string& control_topic, TickStore* tick_store)
+        : index(index)
+        , endpoint(endpoint)
+        , subscriber(context, zmq::socket_type::sub)
+        , wakeup_receiver(context, zmq::socket_type::pair)
+        , wakeup_sender(context, zmq::socket_type::pair)
+    {
+        subscriber.set(zmq::sockopt::rcvhwm, static_cast<int>(receive_hwm));
+        subscriber.connect(endpoint);
+
+        // Empty subscribes to everything; per-symbol quote topics are added when filtering
+        subscriber.set(zmq::sockopt::subscribe, control_topic);
+
+        const std::string wakeup_endpoint = "inproc://cli-wakeup-" + std::to_string(index);
+        wakeup_receiver.bind(wakeup_endpoint);
+        wakeup_sender.connect(wakeup_endpoint);
+
+        if (tick_store) {
+            tick_writer = std::make_unique<TickStore::Writer>(*tick_store);
+        }
+    }
+
+    void FeedShard::post(std::function<void(FeedShard&)> task) {
+        std::lock_guard<std::mutex> lock(task_mutex);
+        tasks.push_back(std::move(task));
+        wakeup_sender.send(zmq::message_t(), zmq::send_flags::dontwait);
+    }
+
+    void FeedShard::wake() {
+        std::lock_guard<std::mutex> lock(task_mutex);
+        wakeup_sender.send(zmq::message_t(), zmq::send_flags::dontwait);
+    }
+
+    void FeedShard::runTasks() {
+        zmq::message_t signal;
+        while (wakeup_receiver.recv(signal, zmq::recv_flags::dontwait)) {}
+
+        std::vector<std::function<void(FeedShard&)>> pending;
+        {
+            std::lock_guard<std::mutex> lock(task_mutex);
+            pending.swap(tasks);
+        }
+        for (auto& task : pending) {
+            task(*this);
+        }
+    }
+}
@@ -0,0 +1,68 @@
+#include "FxTable.h"
+#include <spdlog/spdlog.h>
+#include <string>
+
+
+namespace StockTracker {
+
+    FxFactors::FxFactors() {
+        factor.fill(1.0);
+        for (size_t i = 0; i < display.size(); ++i) {
+            display[i] = static_cast<CurrencyId>(i);
+        }
+    }
+
+    FxTable::FxTable(CurrencyService& service, std::chrono::seconds ttl)
+        : service(service)
+        , ttl(ttl)
+    {
+        usd_rates[Currencies::USD] = 1.0;
+    }
+
+    FxFactors FxTable::prepare(CurrencyId target, const CurrencySet& sources) {
+        FxFactors factors;
+        factors.target = target;
+
+        // Amounts already in the target currency need no rate at all
+        CurrencySet needed = sources;
+        needed.reset(target);
+        if (needed.none()) {
+            return factors;
+        }
+        needed.set(target);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        const auto now = Clock::now();
+        for (size_t i = 0; i < needed.size(); ++i) {
+            if (needed.test(i) && i != Currencies::USD && now >= expires[i]) {
+                refresh(static_cast<CurrencyId>(i), now);
+            }
+        }
+
+        // One rate per currency pair; anything without both rates stays as it is
+        const double target_rate = usd_rates[target];
+        if (target_rate == 0.0) {
+            return factors;
+        }
+        for (size_t i = 0; i < needed.size(); ++i) {
+            if (needed.test(i) && usd_rates[i] != 0.0) {
+                factors.factor[i] = target_rate / usd_rates[i];
+                factors.display[i] = target;
+            }
+        }
+        return factors;
+    }
+
+    void FxTable::refresh(CurrencyId id, Clock::time_point now) {
+        expires[id] = now + ttl;
+        try {
+            const double rate = service.convertCurrency(1.0, std::string(Currencies::code(id)));
+            if (rate > 0.0) {
+                usd_rates[id] = rate;
+            }
+        }
+        catch (const std::exception& e) {
+            spdlog::warn("Could not fetch the USD/{} rate: {}", Currencies::code(id), e.what());
+        }
+    }
+}
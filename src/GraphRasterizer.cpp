@@ -0,0 +1,111 @@
+#include "GraphRasterizer.h"
+#include <algorithm>
+#include <cstdio>
+#include <limits>
+
+
+namespace StockTracker {
+    namespace {
+        // Braille dot bits by [column][row] within a 2x4 cell
+        constexpr uint8_t BRAILLE_DOTS[2][4] = {
+            { 0x01, 0x02, 0x04, 0x40 },
+            { 0x08, 0x10, 0x20, 0x80 },
+        };
+
+        void appendBraille(std::string& out, uint8_t dots) {
+            // U+2800 + dots, as UTF-8
+            out += static_cast<char>(0xE2);
+            out += static_cast<char>(0xA0 | (dots >> 6));
+            out += static_cast<char>(0x80 | (dots & 0x3F));
+        }
+    }
+
+    const std::string& GraphRasterizer::render(Span<double> prices, const GraphOptions& options) {
+        output.clear();
+        if (prices.empty() || options.height == 0) {
+            return output;
+        }
+
+        const size_t dot_width = options.braille ? 2 : 1;
+        const size_t dot_height = options.braille ? 4 : 1;
+        // One spare column so a full-width line never wraps
+        const size_t max_cells = options.width > AXIS_WIDTH + 1 ? options.width - AXIS_WIDTH - 1 : 1;
+        const size_t columns = std::min(prices.size(), max_cells * dot_width);
+        const size_t cells = (columns + dot_width - 1) / dot_width;
+        const size_t dot_rows = options.height * dot_height;
+
+        // Single pass over the samples: each one lands in exactly one column bucket
+        column_min.assign(columns, std::numeric_limits<double>::infinity());
+        column_max.assign(columns, -std::numeric_limits<double>::infinity());
+        const size_t count = prices.size();
+        for (size_t i = 0; i < count; ++i) {
+            const size_t column = i * columns / count;
+            column_min[column] = std::min(column_min[column], prices[i]);
+            column_max[column] = std::max(column_max[column], prices[i]);
+        }
+
+        GraphBounds bounds;
+        if (options.bounds) {
+            bounds = *options.bounds;
+        }
+        else {
+            bounds.min = *std::min_element(column_min.begin(), column_min.end());
+            bounds.max = *std::max_element(column_max.begin(), column_max.end());
+        }
+        const double range = bounds.max - bounds.min;
+
+        // Dot row 0 is the top of the plot. A flat series is drawn through the middle.
+        auto rowOf = [&](double price) -> size_t {
+            if (range <= 0.0) {
+                return dot_rows / 2;
+            }
+            const double offset = (bounds.max - std::clamp(price, bounds.min, bounds.max)) / range;
+            return static_cast<size_t>(offset * static_cast<double>(dot_rows - 1) + 0.5);
+        };
+
+        grid.assign(options.height * cells, 0);
+        for (size_t column = 0; column < columns; ++column) {
+            const size_t cell = column / dot_width;
+            const size_t dot_x = column % dot_width;
+            for (size_t row = rowOf(column_max[column]), bottom = rowOf(column_min[column]); row <= bottom; ++row) {
+                grid[(row / dot_height) * cells + cell] |= options.braille ? BRAILLE_DOTS[dot_x][row % dot_height] : 1;
+            }
+        }
+
+        // Compose the frame: price axis, plot rows, time axis
+        char label[32];
+        for (size_t r = 0; r < options.height; ++r) {
+            const double level = dot_rows > 1
+                ? bounds.max - range * static_cast<double>(r * dot_height) / static_cast<double>(dot_rows - 1)
+                : bounds.max;
+            std::snprintf(label, sizeof(label), "%8.2f | ", level);
+            output += label;
+
+            const uint8_t* row = grid.data() + r * cells;
+            for (size_t c = 0; c < cells; ++c) {
+                if (row[c] == 0) {
+                    output += ' ';
+                }
+                else if (options.braille) {
+                    appendBraille(output, row[c]);
+                }
+                else {
+                    output += '*';
+                }
+            }
+            output += '\n';
+        }
+
+        output.append(AXIS_WIDTH - 2, ' ');
+        output += '+';
+        output.append(cells + 1, '-');
+        std::snprintf(label, sizeof(label), "%zu", count);
+        output.append("\n").append(AXIS_WIDTH, ' ').append(label).append(" ticks");
+        if (count > columns) {
+            std::snprintf(label, sizeof(label), ", ~%zu per column", (count + columns - 1) / columns);
+            output += label;
+        }
+        output += ", time ->\n";
+        return output;
+    }
+}
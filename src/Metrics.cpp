@@ -0,0 +1,174 @@
+#include "Metrics.h"
+#include <algorithm>
+#include <iomanip>
+
+
+namespace StockTracker {
+    namespace {
+        unsigned highestBit(uint64_t value) {
+            unsigned bit = 0;
+            for (unsigned step = 32; step > 0; step /= 2) {
+                if (value >> (bit + step)) {
+                    bit += step;
+                }
+            }
+            return bit;
+        }
+
+        void reportLine(std::ostream& out, const char* name, const LatencyHistogram& histogram) {
+            const auto s = histogram.summary();
+            auto us = [](int64_t ns) { return static_cast<double>(ns) / 1000.0; };
+            out << "  " << std::left << std::setw(12) << name << std::right
+                << std::setw(10) << s.count
+                << std::setw(11) << us(static_cast<int64_t>(s.mean_ns))
+                << std::setw(11) << us(s.p50_ns)
+                << std::setw(11) << us(s.p90_ns)
+                << std::setw(11) << us(s.p99_ns)
+                << std::setw(11) << us(s.p999_ns)
+                << std::setw(11) << us(s.max_ns) << "\n";
+        }
+
+        void jsonHistogram(std::ostream& out, const char* name, const LatencyHistogram& histogram) {
+            const auto s = histogram.summary();
+            out << "\"" << name << "\":{\"count\":" << s.count
+                << ",\"mean_ns\":" << static_cast<int64_t>(s.mean_ns)
+                << ",\"p50_ns\":" << s.p50_ns << ",\"p90_ns\":" << s.p90_ns
+                << ",\"p99_ns\":" << s.p99_ns << ",\"p999_ns\":" << s.p999_ns
+                << ",\"max_ns\":" << s.max_ns << "}";
+        }
+    }
+
+    size_t LatencyHistogram::bucketOf(uint64_t value) {
+        if (value < SUB_BUCKETS) {
+            return static_cast<size_t>(value);
+        }
+        const unsigned shift = std::min(highestBit(value), MAX_VALUE_BITS - 1) - SUB_BUCKET_BITS;
+        const uint64_t sub = std::min(value >> shift, SUB_BUCKETS * 2 - 1); // Values past the range share the last bucket
+        return static_cast<size_t>(shift * SUB_BUCKETS + sub);
+    }
+
+    uint64_t LatencyHistogram::bucketValue(size_t bucket) {
+        if (bucket < SUB_BUCKETS) {
+            return bucket;
+        }
+        const uint64_t shift = bucket / SUB_BUCKETS - 1;
+        const uint64_t sub = bucket % SUB_BUCKETS + SUB_BUCKETS;
+        return ((sub + 1) << shift) - 1;
+    }
+
+    void LatencyHistogram::record(int64_t ns) {
+        const uint64_t value = ns > 0 ? static_cast<uint64_t>(ns) : 0;
+        auto& bucket = counts[bucketOf(value)];
+        bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        sum_ns.store(sum_ns.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+        if (value > max_ns.load(std::memory_order_relaxed)) {
+            max_ns.store(value, std::memory_order_relaxed);
+        }
+    }
+
+    void LatencyHistogram::merge(const LatencyHistogram& other) {
+        for (size_t i = 0; i < BUCKETS; ++i) {
+            counts[i].store(counts[i].load(std::memory_order_relaxed) + other.counts[i].load(std::memory_order_relaxed),
+                std::memory_order_relaxed);
+        }
+        sum_ns.store(sum_ns.load(std::memory_order_relaxed) + other.sum_ns.load(std::memory_order_relaxed),
+            std::memory_order_relaxed);
+        max_ns.store(std::max(max_ns.load(std::memory_order_relaxed), other.max_ns.load(std::memory_order_relaxed)),
+            std::memory_order_relaxed);
+    }
+
+    LatencyHistogram::Summary LatencyHistogram::summary() const {
+        Summary s;
+        std::array<uint64_t, BUCKETS> snapshot;
+        for (size_t i = 0; i < BUCKETS; ++i) {
+            snapshot[i] = counts[i].load(std::memory_order_relaxed);
+            s.count += snapshot[i];
+        }
+        if (s.count == 0) {
+            return s;
+        }
+        s.max_ns = static_cast<int64_t>(max_ns.load(std::memory_order_relaxed));
+        s.mean_ns = static_cast<double>(sum_ns.load(std::memory_order_relaxed)) / static_cast<double>(s.count);
+
+        // One walk over the buckets for all percentiles, clamped to the exact maximum
+        const std::array<double, 4> quantiles{ 0.50, 0.90, 0.99, 0.999 };
+        std::array<int64_t*, 4> results{ &s.p50_ns, &s.p90_ns, &s.p99_ns, &s.p999_ns };
+        uint64_t seen = 0;
+        size_t next = 0;
+        for (size_t i = 0; i < BUCKETS && next < quantiles.size(); ++i) {
+            seen += snapshot[i];
+            while (next < quantiles.size() && static_cast<double>(seen) >= quantiles[next] * static_cast<double>(s.count)) {
+                *results[next++] = std::min(static_cast<int64_t>(bucketValue(i)), s.max_ns);
+            }
+        }
+        return s;
+    }
+
+    void Gauge::merge(const Gauge& other) {
+        last.store(current() + other.current(), std::memory_order_relaxed);
+        peak.store(std::max(max(), other.max()), std::memory_order_relaxed);
+    }
+
+    void PipelineMetrics::merge(const PipelineMetrics& other) {
+        feed_age.merge(other.feed_age);
+        decode.merge(other.decode);
+        apply.merge(other.apply);
+        messages.add(other.messages.load());
+        quotes.add(other.quotes.load());
+        malformed.add(other.malformed.load());
+        drain_batch.merge(other.drain_batch);
+        gaps.add(other.gaps.load());
+        missed.add(other.missed.load());
+        stale.add(other.stale.load());
+        resyncs.add(other.resyncs.load());
+        recovered.add(other.recovered.load());
+        staleness.merge(other.staleness);
+        render.merge(other.render);
+        conflated.merge(other.conflated);
+    }
+
+    void PipelineMetrics::writeReport(std::ostream& out) const {
+        out << std::fixed << std::setprecision(1)
+            << "  " << std::left << std::setw(12) << "stage (us)" << std::right
+            << std::setw(10) << "count" << std::setw(11) << "mean" << std::setw(11) << "p50"
+            << std::setw(11) << "p90" << std::setw(11) << "p99" << std::setw(11) << "p99.9"
+            << std::setw(11) << "max" << "\n";
+        reportLine(out, "feed age", feed_age);
+        reportLine(out, "decode", decode);
+        reportLine(out, "apply", apply);
+        reportLine(out, "render", render);
+        reportLine(out, "staleness", staleness);
+        out << "  messages " << messages.load() << ", quotes applied " << quotes.load()
+            << ", malformed dropped " << malformed.load() << "\n"
+            << "  sequence gaps " << gaps.load() << " (" << missed.load() << " ticks missed)"
+            << ", stale dropped " << stale.load()
+            << ", resyncs " << resyncs.load() << " (" << recovered.load() << " ticks recovered)\n"
+            << "  drain batch " << drain_batch.current() << " (max " << drain_batch.max() << ")"
+            << ", conflated symbols " << conflated.current() << " (max " << conflated.max() << ")\n";
+    }
+
+    void PipelineMetrics::writeJson(std::ostream& out) const {
+        out << "{\"time_ns\":" << std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count()
+            << ",\"messages\":" << messages.load()
+            << ",\"quotes\":" << quotes.load()
+            << ",\"malformed\":" << malformed.load()
+            << ",\"gaps\":" << gaps.load()
+            << ",\"missed\":" << missed.load()
+            << ",\"stale\":" << stale.load()
+            << ",\"resyncs\":" << resyncs.load()
+            << ",\"recovered\":" << recovered.load()
+            << ",\"drain_batch_max\":" << drain_batch.max()
+            << ",\"conflated_max\":" << conflated.max() << ",";
+        jsonHistogram(out, "feed_age", feed_age);
+        out << ",";
+        jsonHistogram(out, "decode", decode);
+        out << ",";
+        jsonHistogram(out, "apply", apply);
+        out << ",";
+        jsonHistogram(out, "render", render);
+        out << ",";
+        jsonHistogram(out, "staleness", staleness);
+        out << "}";
+    }
+}
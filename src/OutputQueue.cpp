@@ -0,0 +1,191 @@
+#include "OutputQueue.h"
+#include <spdlog/spdlog.h>
+#include <spdlog/sinks/base_sink.h>
+#include <chrono>
+
+
+namespace StockTracker {
+    namespace {
+        // Formats on the logging thread and hands the text to the queue; nothing here writes.
+        class QueueSink : public spdlog::sinks::base_sink<std::mutex> {
+        public:
+            explicit QueueSink(OutputQueue& queue) : queue(queue) {}
+
+        protected:
+            void sink_it_(const spdlog::details::log_msg& msg) override {
+                spdlog::memory_buf_t formatted;
+                formatter_->format(msg, formatted);
+                queue.push(std::string(formatted.data(), formatted.size()));
+            }
+
+            void flush_() override {}
+
+        private:
+            OutputQueue& queue;
+        };
+    }
+
+    OutputQueue::Line::~Line() {
+        if (queue && tellp() > 0) {
+            queue->push(str());
+        }
+    }
+
+    OutputQueue::OutputQueue(std::ostream& sink, size_t capacity)
+        : sink(sink)
+    {
+        size_t size = 2;
+        while (size < capacity) {
+            size *= 2;
+        }
+        cells = std::make_unique<Cell[]>(size);
+        mask = size - 1;
+        for (size_t i = 0; i < size; ++i) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        writer = std::thread(&OutputQueue::writeLoop, this);
+    }
+
+    OutputQueue::~OutputQueue() {
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex);
+            stopping = true;
+            paused = false; // Everything still queued is written
+        }
+        wake.notify_one();
+        writer.join();
+    }
+
+    bool OutputQueue::push(std::string text) {
+        if (!enqueue(text)) {
+            drops.fetch_add(1, std::memory_order_relaxed); // Full: the writer is a whole ring behind
+            return false;
+        }
+        return true;
+    }
+
+    void OutputQueue::pushWaiting(std::string text) {
+        while (!enqueue(text)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    bool OutputQueue::enqueue(std::string& text) {
+        size_t position = enqueue_position.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &cells[position & mask];
+            const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const auto lag = static_cast<std::ptrdiff_t>(sequence - position);
+            if (lag == 0) {
+                if (enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+            else if (lag < 0) {
+                return false;
+            }
+            else {
+                position = enqueue_position.load(std::memory_order_relaxed);
+            }
+        }
+        cell->text = std::move(text);
+        cell->sequence.store(position + 1, std::memory_order_release);
+
+        // Pairs with the fence in writeLoop: either the writer sees this cell or we see it idle
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (writer_idle.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> lock(wake_mutex);
+            wake.notify_one();
+        }
+        return true;
+    }
+
+    bool OutputQueue::pop(std::string& out) {
+        Cell& cell = cells[dequeue_position & mask];
+        if (cell.sequence.load(std::memory_order_acquire) != dequeue_position + 1) {
+            return false;
+        }
+        out += cell.text;
+        cell.text.clear();
+        cell.sequence.store(dequeue_position + mask + 1, std::memory_order_release);
+        ++dequeue_position;
+        return true;
+    }
+
+    void OutputQueue::writeLoop() {
+        std::string batch;
+        uint64_t reported_drops = 0;
+        for (;;) {
+            batch.clear();
+            {
+                std::lock_guard<std::mutex> sink_lock(sink_mutex);
+                if (!paused.load(std::memory_order_relaxed)) {
+                    while (batch.size() < MAX_WRITE_BYTES && pop(batch)) {}
+
+                    const uint64_t drops_now = drops.load(std::memory_order_relaxed);
+                    if (drops_now != reported_drops) {
+                        batch += "[" + std::to_string(drops_now - reported_drops) + " lines of output dropped]\n";
+                        reported_drops = drops_now;
+                    }
+
+                    if (!batch.empty()) {
+                        sink.write(batch.data(), static_cast<std::streamsize>(batch.size()));
+                        sink.flush();
+                        written.store(dequeue_position, std::memory_order_release);
+                    }
+                }
+            }
+            if (!batch.empty()) {
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(wake_mutex);
+            if (stopping) {
+                break;
+            }
+            writer_idle.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            wake.wait(lock, [this] {
+                return stopping || (!paused && cells[dequeue_position & mask].sequence.load(std::memory_order_acquire) == dequeue_position + 1);
+            });
+            writer_idle.store(false, std::memory_order_relaxed);
+        }
+    }
+
+    void OutputQueue::waitUntilWritten() const {
+        const size_t target = enqueue_position.load(std::memory_order_acquire);
+        while (written.load(std::memory_order_acquire) < target) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    void OutputQueue::pause() {
+        std::lock_guard<std::mutex> lock(sink_mutex);
+        paused = true;
+    }
+
+    void OutputQueue::resume() {
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex);
+            paused = false;
+        }
+        wake.notify_one();
+    }
+
+    size_t OutputQueue::pending() const {
+        return enqueue_position.load(std::memory_order_relaxed) - written.load(std::memory_order_relaxed);
+    }
+
+    LogRoute::LogRoute(OutputQueue& queue)
+        : previous(spdlog::default_logger())
+    {
+        auto logger = std::make_shared<spdlog::logger>(previous->name(), std::make_shared<QueueSink>(queue));
+        logger->set_level(previous->level());
+        spdlog::set_default_logger(logger);
+    }
+
+    LogRoute::~LogRoute() {
+        spdlog::set_default_logger(previous);
+    }
+}
@@ -0,0 +1,246 @@
+#include "QuoteStore.h"
+#include <algorithm>
+#include <thread>
+
+
+namespace StockTracker {
+
+    QuoteStore::QuoteStore(size_t history_depth)
+        : history_depth(history_depth)
+    {
+        publish(std::make_unique<Directory>());
+    }
+
+    QuoteStore::~QuoteStore() = default;
+
+    bool QuoteStore::add(std::string_view symbol) {
+        return add(std::vector<std::string>{ std::string(symbol) }) > 0;
+    }
+
+    size_t QuoteStore::add(const std::vector<std::string>& symbols) {
+        std::lock_guard<std::mutex> lock(writer_mutex);
+        const Directory* current = directory.load(std::memory_order_relaxed);
+        std::unique_ptr<Directory> next;
+
+        for (const auto& symbol : symbols) {
+            const SymbolKey key = symbolKey(symbol);
+            if (key == NO_SYMBOL || current->find(key) || (next && next->find(key))) {
+                continue;
+            }
+
+            // A slot is fully initialised before it becomes reachable through the directory.
+            // A retired slot may still be written by an in-flight update for the same symbol,
+            // which is harmless, so it is reused as-is rather than reset.
+            Slot* slot = nullptr;
+            if (auto it = retired.find(key); it != retired.end()) {
+                slot = it->second;
+                retired.erase(it);
+            }
+            else {
+                slot = &slots.emplace_back(history_depth);
+            }
+
+            if (!next) {
+                next = std::make_unique<Directory>(*current);
+            }
+            next->insert(key, slot);
+        }
+
+        if (!next) {
+            return 0;
+        }
+        const size_t added = next->size() - current->size();
+        publish(std::move(next));
+        return added;
+    }
+
+    bool QuoteStore::erase(std::string_view symbol) {
+        return erase(std::vector<std::string>{ std::string(symbol) }) > 0;
+    }
+
+    size_t QuoteStore::erase(const std::vector<std::string>& symbols) {
+        std::lock_guard<std::mutex> lock(writer_mutex);
+        const Directory* current = directory.load(std::memory_order_relaxed);
+        std::unique_ptr<Directory> next;
+
+        for (const auto& symbol : symbols) {
+            const SymbolKey key = symbolKey(symbol);
+            Slot* const* slot = (next ? next.get() : current)->find(key);
+            if (!slot) {
+                continue;
+            }
+
+            // The slot itself stays allocated: a reader or the ingest thread may still hold it.
+            retired.emplace(key, *slot);
+            if (!next) {
+                next = std::make_unique<Directory>(*current);
+            }
+            next->erase(key);
+        }
+
+        if (!next) {
+            return 0;
+        }
+        const size_t removed = current->size() - next->size();
+        publish(std::move(next));
+        return removed;
+    }
+
+    bool QuoteStore::claim(Slot& slot, uint32_t writer, bool& claimed) {
+        // A relaxed load once the symbol is ours; the CAS only runs for its first write
+        uint32_t owner = slot.writer.load(std::memory_order_relaxed);
+        if (owner == writer) {
+            return true;
+        }
+        if (owner == NO_WRITER && slot.writer.compare_exchange_strong(owner, writer, std::memory_order_acq_rel)) {
+            claimed = true;
+            return true;
+        }
+        return owner == writer;
+    }
+
+    std::optional<StockData> QuoteStore::apply(const QuoteTick& tick, uint32_t writer, bool& claimed) {
+        Slot* slot = findSlot(tick.key);
+        if (!slot || !claim(*slot, writer, claimed)) {
+            return std::nullopt;
+        }
+
+        StockData data = slot->data.load();
+        data.current_price = tick.price;
+        data.change_percent = tick.change_percent;
+        data.setCurrency(tick.currency);
+        slot->data.store(data);
+        slot->history.append(tick.timestamp_ns, tick.price, tick.volume);
+        slot->analytics.add(tick.price, tick.volume);
+        slot->stats.store(slot->analytics.current());
+        return data;
+    }
+
+    void QuoteStore::restore(std::string_view symbol, const StockData& data) {
+        add(symbol);
+        if (Slot* slot = findSlot(symbolKey(symbol))) {
+            slot->data.store(data);
+        }
+    }
+
+    QuoteStore::Slot* QuoteStore::resetHistory(std::string_view symbol, uint32_t writer, bool& claimed) {
+        Slot* slot = findSlot(symbolKey(symbol));
+        if (!slot) {
+            add(symbol);
+            slot = findSlot(symbolKey(symbol));
+        }
+        if (slot && !claim(*slot, writer, claimed)) {
+            return nullptr;
+        }
+        if (slot) {
+            slot->history.clear();
+            slot->analytics.clear();
+        }
+        return slot;
+    }
+
+    std::optional<StockData> QuoteStore::find(std::string_view symbol) const {
+        if (const Slot* slot = findSlot(symbolKey(symbol))) {
+            return slot->data.load();
+        }
+        return std::nullopt;
+    }
+
+    bool QuoteStore::contains(std::string_view symbol) const {
+        return findSlot(symbolKey(symbol)) != nullptr;
+    }
+
+    std::optional<uint32_t> QuoteStore::writerOf(std::string_view symbol) const {
+        if (const Slot* slot = findSlot(symbolKey(symbol))) {
+            const uint32_t writer = slot->writer.load(std::memory_order_acquire);
+            if (writer != NO_WRITER) {
+                return writer;
+            }
+        }
+        return std::nullopt;
+    }
+
+    std::optional<SymbolStats> QuoteStore::stats(std::string_view symbol) const {
+        if (const Slot* slot = findSlot(symbolKey(symbol))) {
+            return slot->stats.load();
+        }
+        return std::nullopt;
+    }
+
+    size_t QuoteStore::copyHistory(std::string_view symbol, TickSeries& out, size_t newest) const {
+        if (const Slot* slot = findSlot(symbolKey(symbol))) {
+            return slot->history.copyTo(out, newest);
+        }
+        out.clear();
+        return 0;
+    }
+
+    std::vector<std::pair<std::string, StockData>> QuoteStore::snapshot() const {
+        const ReadGuard guard(*this);
+        std::vector<std::pair<std::string, StockData>> result;
+        result.reserve(guard.directory().size());
+        guard.directory().forEach([&](const SymbolKey& key, Slot* slot) {
+            result.emplace_back(symbolName(key), slot->data.load());
+        });
+        return result;
+    }
+
+    size_t QuoteStore::size() const {
+        const ReadGuard guard(*this);
+        return guard.directory().size();
+    }
+
+    bool QuoteStore::empty() const {
+        return size() == 0;
+    }
+
+    QuoteStore::Slot* QuoteStore::findSlot(SymbolKey key) const {
+        // Slots outlive the guard; only the directory can be freed
+        const ReadGuard guard(*this);
+        Slot* const* slot = guard.directory().find(key);
+        return slot ? *slot : nullptr;
+    }
+
+    void QuoteStore::publish(std::unique_ptr<Directory> next) {
+        directory.store(next.get(), std::memory_order_seq_cst);
+        std::unique_ptr<const Directory> previous = std::move(published);
+        published = std::move(next);
+        if (!previous) {
+            return;
+        }
+
+        // Readers counted from now on load the new directory. Only those already counted
+        // in the generation being left can still hold `previous`; each is inside one call.
+        const uint32_t left = generation.fetch_add(1, std::memory_order_seq_cst) & 1;
+        for (const ReaderCount& stripe : readers[left]) {
+            while (stripe.count.load(std::memory_order_seq_cst) != 0) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    size_t QuoteStore::readerStripe() {
+        static std::atomic<size_t> next_stripe{ 0 };
+        thread_local const size_t stripe = next_stripe.fetch_add(1, std::memory_order_relaxed) % READER_STRIPES;
+        return stripe;
+    }
+
+    QuoteStore::ReadGuard::ReadGuard(const QuoteStore& store) {
+        // Retried if publish() moved to the other generation between the load and the count
+        const size_t stripe = readerStripe();
+        for (;;) {
+            const uint32_t generation = store.generation.load(std::memory_order_seq_cst);
+            count = &store.readers[generation & 1][stripe].count;
+            count->fetch_add(1, std::memory_order_seq_cst);
+            if (store.generation.load(std::memory_order_seq_cst) == generation) {
+                break;
+            }
+            count->fetch_sub(1, std::memory_order_release);
+        }
+        current = store.directory.load(std::memory_order_acquire);
+    }
+
+    QuoteStore::ReadGuard::~ReadGuard() {
+        count->fetch_sub(1, std::memory_order_release);
+    }
+}
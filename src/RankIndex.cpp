@@ -0,0 +1,178 @@
+#include "RankIndex.h"
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <limits>
+
+
+namespace StockTracker {
+    namespace {
+        constexpr std::pair<std::string_view, RankKey> RANK_KEY_NAMES[] = {
+            { "change", RankKey::Change },
+            { "movers", RankKey::Movers },
+            { "price", RankKey::Price },
+            { "volume", RankKey::Volume },
+            { "symbol", RankKey::Symbol },
+        };
+
+        // Emits elements [offset, offset + count) of `set` in the order asked for, walking
+        // in from whichever end is nearer.
+        template <typename Set, typename Emit>
+        void walk(const Set& set, bool descending, size_t offset, size_t count, Emit&& emit) {
+            if (offset >= set.size()) {
+                return;
+            }
+            count = std::min(count, set.size() - offset);
+            const size_t first = descending ? set.size() - offset - count : offset;
+
+            auto it = first <= set.size() - first - count
+                ? std::next(set.begin(), first)
+                : std::prev(set.end(), set.size() - first);
+            if (descending) {
+                auto last = std::next(it, count);
+                for (size_t i = 0; i < count; ++i) {
+                    emit(*--last);
+                }
+            }
+            else {
+                for (size_t i = 0; i < count; ++i, ++it) {
+                    emit(*it);
+                }
+            }
+        }
+    }
+
+    std::optional<RankKey> parseRankKey(std::string_view name) {
+        for (const auto& [text, key] : RANK_KEY_NAMES) {
+            if (text == name) {
+                return key;
+            }
+        }
+        return std::nullopt;
+    }
+
+    std::string_view rankKeyName(RankKey key) {
+        for (const auto& [text, value] : RANK_KEY_NAMES) {
+            if (value == key) {
+                return text;
+            }
+        }
+        return {};
+    }
+
+    double RankIndex::rankValue(RankKey key, const Row& row) {
+        double value = 0.0;
+        switch (key) {
+        case RankKey::Change: value = row.data.change_percent; break;
+        case RankKey::Movers: value = std::abs(row.data.change_percent); break;
+        case RankKey::Price: value = row.data.current_price; break;
+        case RankKey::Volume: value = row.volume; break;
+        case RankKey::Symbol: break;
+        }
+        // NaN has no place in an ordering; rank it below everything
+        return std::isnan(value) ? -std::numeric_limits<double>::infinity() : value;
+    }
+
+    bool RankIndex::before(RankKey key, const Row& a, const Row& b) {
+        if (key == RankKey::Symbol) {
+            return symbolName(a.key) < symbolName(b.key);
+        }
+        return std::make_pair(rankValue(key, a), a.key) < std::make_pair(rankValue(key, b), b.key);
+    }
+
+    void RankIndex::move(Ranking& ranking, SymbolKey key, double from, double to) {
+        if (from == to) {
+            return;
+        }
+        auto node = ranking.extract({ from, key });
+        node.value().first = to;
+        ranking.insert(std::move(node));
+    }
+
+    void RankIndex::update(SymbolKey key, const StockData& data, double volume) {
+        std::lock_guard<std::mutex> lock(mutex);
+        Row* row = rows.find(key);
+        if (!row) {
+            rows.insert(key, { key, data, volume });
+            row = rows.find(key);
+            for (size_t i = 0; i < NUMERIC_KEYS; ++i) {
+                rankings[i].emplace(rankValue(static_cast<RankKey>(i), *row), key);
+            }
+            by_symbol.insert(key);
+            return;
+        }
+
+        const Row before = *row;
+        row->data = data;
+        row->volume += volume;
+        for (size_t i = 0; i < NUMERIC_KEYS; ++i) {
+            const auto rank_key = static_cast<RankKey>(i);
+            move(rankings[i], key, rankValue(rank_key, before), rankValue(rank_key, *row));
+        }
+    }
+
+    void RankIndex::erase(SymbolKey key) {
+        std::lock_guard<std::mutex> lock(mutex);
+        const Row* row = rows.find(key);
+        if (!row) {
+            return;
+        }
+        for (size_t i = 0; i < NUMERIC_KEYS; ++i) {
+            rankings[i].erase({ rankValue(static_cast<RankKey>(i), *row), key });
+        }
+        by_symbol.erase(key);
+        rows.erase(key);
+    }
+
+    void RankIndex::page(RankKey key, bool descending, size_t offset, size_t count, std::vector<Row>& page) const {
+        page.clear();
+        std::lock_guard<std::mutex> lock(mutex);
+        if (key == RankKey::Symbol) {
+            walk(by_symbol, descending, offset, count, [&](SymbolKey symbol) { page.push_back(*rows.find(symbol)); });
+        }
+        else {
+            walk(rankings[static_cast<size_t>(key)], descending, offset, count,
+                [&](const std::pair<double, SymbolKey>& entry) { page.push_back(*rows.find(entry.second)); });
+        }
+    }
+
+    void RankIndex::page(const std::vector<const RankIndex*>& indexes, RankKey key, bool descending,
+        size_t offset, size_t count, std::vector<Row>& page)
+    {
+        if (indexes.size() == 1) {
+            indexes.front()->page(key, descending, offset, count, page);
+            return;
+        }
+
+        // Rows before the page in the merged order are among the first offset + count of some index
+        const size_t needed = count > std::numeric_limits<size_t>::max() - offset ? count : offset + count;
+        std::vector<Row> merged;
+        std::vector<Row> part;
+        for (const RankIndex* index : indexes) {
+            index->page(key, descending, 0, needed, part);
+            const auto middle = merged.insert(merged.end(), part.begin(), part.end());
+            std::inplace_merge(merged.begin(), middle, merged.end(), [&](const Row& a, const Row& b) {
+                return descending ? before(key, b, a) : before(key, a, b);
+            });
+        }
+
+        page.clear();
+        if (offset < merged.size()) {
+            const auto first = merged.begin() + static_cast<std::ptrdiff_t>(offset);
+            page.assign(first, first + static_cast<std::ptrdiff_t>(std::min(count, merged.size() - offset)));
+        }
+    }
+
+    size_t RankIndex::size() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return rows.size();
+    }
+
+    size_t RankIndex::size(const std::vector<const RankIndex*>& indexes) {
+        size_t total = 0;
+        for (const RankIndex* index : indexes) {
+            total += index->size();
+        }
+        return total;
+    }
+}
@@ -0,0 +1,126 @@
+#include "RollingStats.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+
+namespace StockTracker {
+
+    void RollingStats::Moments::push(double x) {
+        ++count;
+        const double delta = x - mean;
+        mean += delta / static_cast<double>(count);
+        m2 += delta * (x - mean);
+    }
+
+    void RollingStats::Moments::replace(double out, double in) {
+        // Same count, so the mean shifts by the difference and m2 by its product with both deviations
+        const double old_mean = mean;
+        mean += (in - out) / static_cast<double>(count);
+        m2 = std::max(0.0, m2 + (in - out) * (in - mean + out - old_mean));
+    }
+
+    double RollingStats::Moments::stddev() const {
+        return count > 1 ? std::sqrt(m2 / static_cast<double>(count - 1)) : 0.0;
+    }
+
+    template <typename Before>
+    void RollingStats::slide(MonotonicDeque& deque, size_t length, Before before) {
+        const uint64_t tick = stats.ticks;
+
+        // Drop ticks that left the window, then any the new price dominates
+        while (!deque.empty() && deque.front() + length <= tick) {
+            ++deque.head;
+        }
+        while (!deque.empty() && !before(priceAt(deque.back()), priceAt(tick))) {
+            --deque.tail;
+        }
+        deque.ticks[deque.tail++ % MAX_STATS_WINDOW] = tick;
+    }
+
+    void RollingStats::add(double price, double tick_volume) {
+        const uint64_t tick = stats.ticks;
+        const size_t at = tick % MAX_STATS_WINDOW;
+
+        // Values leaving a window are read before the ring slot is overwritten
+        for (size_t i = 0; i < windows.size(); ++i) {
+            const size_t length = STATS_WINDOWS[i];
+            if (tick >= length) {
+                windows[i].moments.replace(priceAt(tick - length), price);
+            }
+            else {
+                windows[i].moments.push(price);
+            }
+        }
+        if (tick >= MAX_STATS_WINDOW) {
+            price_volume -= prices[at] * volumes[at];
+            volume -= volumes[at];
+        }
+
+        if (tick > 0) {
+            const double previous = priceAt(tick - 1);
+            const double change = previous != 0.0 ? price / previous - 1.0 : 0.0;
+            if (return_moments.count == MAX_STATS_WINDOW - 1) {
+                return_moments.replace(returns[(tick + 1) % MAX_STATS_WINDOW], change);
+            }
+            else {
+                return_moments.push(change);
+            }
+            returns[at] = change;
+        }
+
+        prices[at] = price;
+        volumes[at] = tick_volume;
+        price_volume += price * tick_volume;
+        volume += tick_volume;
+
+        for (size_t i = 0; i < windows.size(); ++i) {
+            slide(windows[i].minima, STATS_WINDOWS[i], std::less<double>());
+            slide(windows[i].maxima, STATS_WINDOWS[i], std::greater<double>());
+        }
+
+        ++stats.ticks;
+        if (stats.ticks % RESYNC_TICKS == 0) {
+            resync();
+        }
+
+        for (size_t i = 0; i < windows.size(); ++i) {
+            const Window& window = windows[i];
+            WindowStats& out = stats.windows[i];
+            const double alpha = 2.0 / (static_cast<double>(STATS_WINDOWS[i]) + 1.0);
+
+            out.ema = tick == 0 ? price : out.ema + alpha * (price - out.ema);
+            out.count = window.moments.count;
+            out.sma = window.moments.mean;
+            out.stddev = window.moments.stddev();
+            out.min = priceAt(window.minima.front());
+            out.max = priceAt(window.maxima.front());
+        }
+        stats.volatility = return_moments.stddev();
+        stats.vwap = volume > 0.0 ? price_volume / volume : 0.0;
+    }
+
+    void RollingStats::resync() {
+        // Only ever called once every window is full
+        for (size_t i = 0; i < windows.size(); ++i) {
+            Moments exact;
+            for (uint64_t tick = stats.ticks - STATS_WINDOWS[i]; tick < stats.ticks; ++tick) {
+                exact.push(priceAt(tick));
+            }
+            windows[i].moments = exact;
+        }
+
+        Moments exact_returns;
+        price_volume = 0.0;
+        volume = 0.0;
+        for (uint64_t tick = stats.ticks - MAX_STATS_WINDOW; tick < stats.ticks; ++tick) {
+            const size_t at = tick % MAX_STATS_WINDOW;
+            price_volume += prices[at] * volumes[at];
+            volume += volumes[at];
+            if (tick > stats.ticks - MAX_STATS_WINDOW) { // One fewer return than prices
+                exact_returns.push(returns[at]);
+            }
+        }
+        return_moments = exact_returns;
+    }
+}
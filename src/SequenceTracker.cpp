@@ -0,0 +1,36 @@
+#include "SequenceTracker.h"
+
+
+namespace StockTracker {
+
+    SequenceCheck SequenceTracker::check(const QuoteTick& tick) {
+        SequenceCheck check;
+        if (tick.sequence == 0 || tick.key == NO_SYMBOL) {
+            return check;
+        }
+
+        Last* seen = last.find(tick.key);
+        if (!seen) {
+            last.insert(tick.key, { tick.sequence, tick.timestamp_ns });
+            return check;
+        }
+
+        if (tick.sequence <= seen->sequence) {
+            const bool newer = tick.timestamp_ns > 0 && seen->timestamp_ns > 0 && tick.timestamp_ns > seen->timestamp_ns;
+            if (tick.sequence == seen->sequence || (!newer && seen->sequence - tick.sequence <= RESET_DISTANCE)) {
+                check.result = SequenceCheck::Result::Stale;
+                return check;
+            }
+            check.result = SequenceCheck::Result::Reset;
+            *seen = { tick.sequence, tick.timestamp_ns };
+            return check;
+        }
+        if (tick.sequence > seen->sequence + 1) {
+            check.result = SequenceCheck::Result::Gap;
+            check.missed = tick.sequence - seen->sequence - 1;
+            check.gap_from_ns = seen->timestamp_ns;
+        }
+        *seen = { tick.sequence, tick.timestamp_ns };
+        return check;
+    }
+}
@@ -0,0 +1,71 @@
+#include "SnapshotCache.h"
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+#include <filesystem>
+#include <fstream>
+
+
+namespace StockTracker::SnapshotCache {
+    namespace {
+        constexpr int FORMAT_VERSION = 1;
+    }
+
+    Entries load(const std::string& path) {
+        Entries entries;
+        std::ifstream in(path);
+        if (!in) {
+            return entries;
+        }
+
+        try {
+            const nlohmann::json doc = nlohmann::json::parse(in);
+            if (doc.value("version", 0) != FORMAT_VERSION) {
+                spdlog::warn("Ignoring cache {}: unsupported format", path);
+                return entries;
+            }
+            for (const auto& item : doc.at("stocks")) {
+                StockData data;
+                data.current_price = item.at("price").get<double>();
+                data.change_percent = item.value("change_percent", 0.0);
+                data.setCurrency(item.value("currency", std::string("USD")));
+                entries.emplace_back(item.at("symbol").get<std::string>(), data);
+            }
+        }
+        catch (const std::exception& e) {
+            spdlog::warn("Ignoring cache {}: {}", path, e.what());
+            entries.clear();
+        }
+        return entries;
+    }
+
+    bool save(const std::string& path, const Entries& entries) {
+        nlohmann::json stocks = nlohmann::json::array();
+        for (const auto& [symbol, data] : entries) {
+            stocks.push_back({
+                { "symbol", symbol },
+                { "price", data.current_price },
+                { "change_percent", data.change_percent },
+                { "currency", std::string(data.currencyCode()) },
+            });
+        }
+        const nlohmann::json doc = { { "version", FORMAT_VERSION }, { "stocks", std::move(stocks) } };
+
+        const std::string temp_path = path + ".tmp";
+        {
+            std::ofstream out(temp_path, std::ios::trunc);
+            out << doc.dump(2) << '\n';
+            out.close();
+            if (!out) {
+                return false;
+            }
+        }
+
+        std::error_code error;
+        std::filesystem::rename(temp_path, path, error);
+        if (error) {
+            std::filesystem::remove(temp_path, error);
+            return false;
+        }
+        return true;
+    }
+}
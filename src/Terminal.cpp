@@ -0,0 +1,38 @@
+#include "Terminal.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+
+
+namespace StockTracker {
+
+    TerminalSize queryTerminalSize() {
+        TerminalSize size;
+#ifdef _WIN32
+        CONSOLE_SCREEN_BUFFER_INFO info;
+        if (GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &info)) {
+            size.columns = static_cast<size_t>(info.srWindow.Right - info.srWindow.Left + 1);
+            size.rows = static_cast<size_t>(info.srWindow.Bottom - info.srWindow.Top + 1);
+        }
+#else
+        winsize ws{};
+        if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) == 0 && ws.ws_col > 0 && ws.ws_row > 0) {
+            size.columns = ws.ws_col;
+            size.rows = ws.ws_row;
+        }
+#endif
+        return size;
+    }
+
+    void enableUtf8Output() {
+#ifdef _WIN32
+        SetConsoleOutputCP(CP_UTF8);
+#endif
+    }
+}
@@ -0,0 +1,37 @@
+#include "ThreadAffinity.h"
+#include <thread>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+
+namespace StockTracker {
+
+    size_t coreCount() {
+        const unsigned cores = std::thread::hardware_concurrency();
+        return cores > 0 ? cores : 1;
+    }
+
+    bool pinCurrentThread(size_t core) {
+        core %= coreCount();
+#ifdef _WIN32
+        if (core >= sizeof(DWORD_PTR) * 8) {
+            return false; // Beyond the first processor group
+        }
+        return SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR{ 1 } << core) != 0;
+#elif defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(core, &set);
+        return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+        return false;
+#endif
+    }
+}
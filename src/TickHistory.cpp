@@ -0,0 +1,83 @@
+#include "TickHistory.h"
+#include <algorithm>
+#include <stdexcept>
+
+
+namespace StockTracker {
+
+    TickHistory::TickHistory(size_t depth)
+        : max_samples(depth)
+        , capacity(depth + WRITE_SLACK)
+        , time_column(2 * capacity)
+        , price_column(2 * capacity)
+        , volume_column(2 * capacity)
+    {
+        if (depth == 0) {
+            throw std::invalid_argument("History depth must be at least 1");
+        }
+    }
+
+    void TickHistory::append(int64_t timestamp_ns, double price, double volume) {
+        const uint64_t sample = head.load(std::memory_order_relaxed);
+
+        // Announce the slot before touching it so concurrent readers can detect the overwrite
+        reserved.store(sample + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        const size_t slot = static_cast<size_t>(sample % capacity);
+        for (const size_t i : { slot, slot + capacity }) {
+            time_column[i].store(timestamp_ns, std::memory_order_relaxed);
+            price_column[i].store(price, std::memory_order_relaxed);
+            volume_column[i].store(volume, std::memory_order_relaxed);
+        }
+
+        const uint64_t oldest = sample + 1 > max_samples ? sample + 1 - max_samples : 0;
+        if (tail.load(std::memory_order_relaxed) < oldest) {
+            tail.store(oldest, std::memory_order_relaxed);
+        }
+        head.store(sample + 1, std::memory_order_release);
+    }
+
+    void TickHistory::clear() {
+        // Jump a whole ring ahead so any in-flight copy fails validation
+        const uint64_t next = head.load(std::memory_order_relaxed) + capacity;
+        reserved.store(next, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        tail.store(next, std::memory_order_relaxed);
+        head.store(next, std::memory_order_release);
+    }
+
+    size_t TickHistory::size() const {
+        const uint64_t end = head.load(std::memory_order_acquire);
+        const uint64_t begin = tail.load(std::memory_order_acquire);
+        return begin < end ? static_cast<size_t>(std::min<uint64_t>(end - begin, max_samples)) : 0;
+    }
+
+    size_t TickHistory::copyTo(TickSeries& out, size_t newest) const {
+        for (;;) {
+            const uint64_t end = head.load(std::memory_order_acquire);
+            const uint64_t begin = tail.load(std::memory_order_acquire);
+            if (begin > end) {
+                continue; // Raced with clear(), reload both
+            }
+
+            const size_t count = static_cast<size_t>(std::min<uint64_t>({ end - begin, max_samples, newest }));
+            const size_t start = windowStart(end, count);
+            out.timestamps.resize(count);
+            out.prices.resize(count);
+            out.volumes.resize(count);
+            for (size_t i = 0; i < count; ++i) {
+                out.timestamps[i] = time_column[start + i].load(std::memory_order_relaxed);
+                out.prices[i] = price_column[start + i].load(std::memory_order_relaxed);
+                out.volumes[i] = volume_column[start + i].load(std::memory_order_relaxed);
+            }
+
+            // The copy is good if the writer has not started on a slot that held one of our samples
+            std::atomic_thread_fence(std::memory_order_acquire);
+            const uint64_t in_flight = reserved.load(std::memory_order_relaxed);
+            if (in_flight + count <= end + capacity) {
+                return count;
+            }
+        }
+    }
+}
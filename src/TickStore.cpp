@@ -0,0 +1,392 @@
+#include "TickStore.h"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+namespace StockTracker {
+    namespace {
+        constexpr uint32_t FILE_MAGIC = 0x54524B54; // "TKRT" little-endian
+        constexpr uint16_t FILE_VERSION = 1;
+        constexpr size_t HEADER_SIZE = 64;          // magic u32, version u16, record size u16, count u64
+        constexpr size_t INITIAL_CAPACITY = 4096;   // Records
+        static_assert(sizeof(TickRecord) == 24, "TickRecord is the on-disk layout");
+
+        // Symbols become file names, so only allow characters that are safe everywhere
+        bool isStorableSymbol(std::string_view symbol) {
+            return !symbol.empty() && symbol.size() <= 16
+                && std::all_of(symbol.begin(), symbol.end(), [](char c) {
+                    return std::isalnum(static_cast<unsigned char>(c)) || c == '.' || c == '-' || c == '_';
+                });
+        }
+    }
+
+    // One symbol's file. Growing the file remaps it, which only happens under an
+    // exclusive remap_mutex; readers hold it shared for as long as they use a view.
+    class TickStore::File {
+    public:
+        File(const std::string& path, int64_t retention_ns);
+        ~File();
+
+        bool append(const TickRecord& record);
+        Span<TickRecord> between(int64_t from_ns, int64_t to_ns) const; // Caller holds remap_mutex
+        Span<TickRecord> last(size_t count) const;                      // Caller holds remap_mutex
+        size_t size() const { return committed.load(std::memory_order_acquire); }
+
+        mutable std::shared_mutex remap_mutex;
+
+    private:
+        TickRecord* records() const { return reinterpret_cast<TickRecord*>(base + HEADER_SIZE); }
+        template <typename Before>
+        size_t partition(int64_t timestamp_ns, size_t count, Before before) const;
+        void map(size_t capacity_records);
+        void unmap();
+        void dropBefore(int64_t cutoff_ns); // Caller holds remap_mutex exclusively
+
+#ifdef _WIN32
+        HANDLE file{ INVALID_HANDLE_VALUE };
+        HANDLE mapping{ nullptr };
+#else
+        int fd{ -1 };
+#endif
+        char* base{ nullptr };
+        size_t capacity{ 0 };
+        std::atomic<size_t> committed{ 0 };
+        const int64_t retention_ns;
+
+        // Timestamp of every INDEX_STRIDE'th record. Entries are written before the record
+        // count that covers them is published, and only reallocated while remapping.
+        std::vector<int64_t> index;
+    };
+
+    TickStore::File::File(const std::string& path, int64_t retention_ns)
+        : retention_ns(retention_ns)
+    {
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+            OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            throw std::runtime_error("cannot open " + path);
+        }
+        LARGE_INTEGER file_size{};
+        GetFileSizeEx(file, &file_size);
+        const size_t existing = static_cast<size_t>(file_size.QuadPart);
+#else
+        fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd < 0) {
+            throw std::runtime_error("cannot open " + path);
+        }
+        struct stat info {};
+        ::fstat(fd, &info);
+        const size_t existing = static_cast<size_t>(info.st_size);
+#endif
+
+        const size_t stored = existing > HEADER_SIZE ? (existing - HEADER_SIZE) / sizeof(TickRecord) : 0;
+        map(std::max(INITIAL_CAPACITY, stored));
+
+        // Reuse the records of a valid file; anything else starts over
+        uint32_t magic = 0;
+        uint16_t version = 0;
+        uint16_t record_size = 0;
+        uint64_t count = 0;
+        std::memcpy(&magic, base, sizeof(magic));
+        std::memcpy(&version, base + 4, sizeof(version));
+        std::memcpy(&record_size, base + 6, sizeof(record_size));
+        std::memcpy(&count, base + 8, sizeof(count));
+
+        if (magic != FILE_MAGIC || version != FILE_VERSION || record_size != sizeof(TickRecord)) {
+            if (existing > 0) {
+                spdlog::warn("Tick file {} has an unknown format, starting it over", path);
+            }
+            std::memset(base, 0, HEADER_SIZE);
+            magic = FILE_MAGIC;
+            version = FILE_VERSION;
+            record_size = static_cast<uint16_t>(sizeof(TickRecord));
+            count = 0;
+            std::memcpy(base, &magic, sizeof(magic));
+            std::memcpy(base + 4, &version, sizeof(version));
+            std::memcpy(base + 6, &record_size, sizeof(record_size));
+            std::memcpy(base + 8, &count, sizeof(count));
+        }
+
+        count = std::min<uint64_t>(count, stored);
+        for (size_t i = 0; i < count; i += INDEX_STRIDE) {
+            index[i / INDEX_STRIDE] = records()[i].timestamp_ns;
+        }
+        committed.store(static_cast<size_t>(count), std::memory_order_release);
+
+        if (retention_ns > 0) {
+            const int64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+            dropBefore(now_ns - retention_ns);
+        }
+    }
+
+    TickStore::File::~File() {
+        const uint64_t count = size();
+        unmap();
+
+        // Drop the preallocated tail so the file holds exactly its records
+        const int64_t used = static_cast<int64_t>(HEADER_SIZE + count * sizeof(TickRecord));
+#ifdef _WIN32
+        LARGE_INTEGER end{};
+        end.QuadPart = used;
+        SetFilePointerEx(file, end, nullptr, FILE_BEGIN);
+        SetEndOfFile(file);
+        CloseHandle(file);
+#else
+        if (::ftruncate(fd, used) != 0) {
+            spdlog::warn("Could not trim tick file");
+        }
+        ::close(fd);
+#endif
+    }
+
+    void TickStore::File::map(size_t capacity_records) {
+        const size_t bytes = HEADER_SIZE + capacity_records * sizeof(TickRecord);
+#ifdef _WIN32
+        // Mapping a file past its end extends it
+        const auto size = static_cast<unsigned long long>(bytes);
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE,
+            static_cast<DWORD>(size >> 32), static_cast<DWORD>(size & 0xFFFFFFFF), nullptr);
+        void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, bytes) : nullptr;
+        if (!view) {
+            throw std::runtime_error("cannot map tick file");
+        }
+#else
+        struct stat info {};
+        ::fstat(fd, &info);
+        if (static_cast<size_t>(info.st_size) < bytes && ::ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+            throw std::runtime_error("cannot grow tick file");
+        }
+        void* view = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (view == MAP_FAILED) {
+            throw std::runtime_error("cannot map tick file");
+        }
+#endif
+        base = static_cast<char*>(view);
+        capacity = capacity_records;
+        index.resize(capacity / INDEX_STRIDE + 1);
+    }
+
+    void TickStore::File::unmap() {
+        if (!base) {
+            return;
+        }
+#ifdef _WIN32
+        UnmapViewOfFile(base);
+        CloseHandle(mapping);
+        mapping = nullptr;
+#else
+        ::munmap(base, HEADER_SIZE + capacity * sizeof(TickRecord));
+#endif
+        base = nullptr;
+    }
+
+    bool TickStore::File::append(const TickRecord& record) {
+        size_t count = committed.load(std::memory_order_relaxed);
+        if (count > 0 && record.timestamp_ns < records()[count - 1].timestamp_ns) {
+            return false;
+        }
+
+        if (count == capacity) {
+            // Expired ticks make room first, measured against the tick being stored
+            std::unique_lock<std::shared_mutex> lock(remap_mutex);
+            if (retention_ns > 0) {
+                dropBefore(record.timestamp_ns - retention_ns);
+                count = size();
+            }
+            if (count > capacity / 2) {
+                const size_t grown = capacity * 2;
+                unmap();
+                map(grown);
+            }
+        }
+
+        // Readers only look below `committed`, so the new slot can be written without a lock
+        records()[count] = record;
+        if (count % INDEX_STRIDE == 0) {
+            index[count / INDEX_STRIDE] = record.timestamp_ns;
+        }
+        const uint64_t stored = count + 1;
+        std::memcpy(base + 8, &stored, sizeof(stored));
+        committed.store(count + 1, std::memory_order_release);
+        return true;
+    }
+
+    void TickStore::File::dropBefore(int64_t cutoff_ns) {
+        const size_t count = size();
+        const size_t first = partition(cutoff_ns, count, [](int64_t t, int64_t record) { return t <= record; });
+        if (first == 0) {
+            return;
+        }
+
+        const size_t kept = count - first;
+        std::memmove(records(), records() + first, kept * sizeof(TickRecord));
+        for (size_t i = 0; i < kept; i += INDEX_STRIDE) {
+            index[i / INDEX_STRIDE] = records()[i].timestamp_ns;
+        }
+        const uint64_t stored = kept;
+        std::memcpy(base + 8, &stored, sizeof(stored));
+        committed.store(kept, std::memory_order_release);
+    }
+
+    template <typename Before>
+    size_t TickStore::File::partition(int64_t timestamp_ns, size_t count, Before before) const {
+        // First record for which before(timestamp_ns, record) holds. The index finds the block,
+        // then a binary search within it finds the record.
+        const size_t blocks = (count + INDEX_STRIDE - 1) / INDEX_STRIDE;
+        const size_t block = static_cast<size_t>(std::partition_point(index.data(), index.data() + blocks,
+            [&](int64_t first) { return !before(timestamp_ns, first); }) - index.data());
+        if (block == 0) {
+            return 0;
+        }
+
+        const TickRecord* begin = records() + (block - 1) * INDEX_STRIDE;
+        const TickRecord* end = records() + std::min(block * INDEX_STRIDE, count);
+        return static_cast<size_t>(std::partition_point(begin, end,
+            [&](const TickRecord& record) { return !before(timestamp_ns, record.timestamp_ns); }) - records());
+    }
+
+    Span<TickRecord> TickStore::File::between(int64_t from_ns, int64_t to_ns) const {
+        const size_t count = size();
+        const size_t first = partition(from_ns, count, [](int64_t t, int64_t record) { return t <= record; });
+        const size_t last = partition(to_ns, count, [](int64_t t, int64_t record) { return t < record; });
+        return { records() + first, last > first ? last - first : 0 };
+    }
+
+    Span<TickRecord> TickStore::File::last(size_t count) const {
+        const size_t stored = size();
+        const size_t taken = std::min(count, stored);
+        return { records() + (stored - taken), taken };
+    }
+
+    TickStore::TickStore(std::string directory, int64_t retention_ns)
+        : directory(std::move(directory))
+        , retention_ns(retention_ns)
+    {
+        std::error_code error;
+        std::filesystem::create_directories(this->directory, error);
+        if (error) {
+            throw std::runtime_error("cannot create tick directory " + this->directory + ": " + error.message());
+        }
+
+        // Earlier sessions' files are readable before this session's first tick for the symbol
+        for (const auto& entry : std::filesystem::directory_iterator(this->directory, error)) {
+            if (entry.path().extension() == ".ticks") {
+                open(symbolKey(entry.path().stem().string()));
+            }
+        }
+    }
+
+    TickStore::~TickStore() = default;
+
+    bool TickStore::Writer::append(std::string_view symbol, int64_t timestamp_ns, double price, double volume) {
+        const SymbolKey key = symbolKey(symbol);
+        File* const* found = files.find(key);
+        File* file = nullptr;
+        if (found) {
+            file = *found;
+        }
+        else if (key != NO_SYMBOL) {
+            file = store.findOrOpen(key);
+            files.insert(key, file);
+        }
+        return file && file->append({ timestamp_ns, price, volume });
+    }
+
+    TickStore::Range TickStore::range(std::string_view symbol, int64_t from_ns, int64_t to_ns) const {
+        Range result;
+        std::shared_lock<std::shared_mutex> files_lock(files_mutex);
+        if (const File* file = find(symbol)) {
+            result.lock = std::shared_lock<std::shared_mutex>(file->remap_mutex);
+            result.view = file->between(from_ns, to_ns);
+        }
+        return result;
+    }
+
+    TickStore::Range TickStore::newest(std::string_view symbol, size_t count) const {
+        Range result;
+        std::shared_lock<std::shared_mutex> files_lock(files_mutex);
+        if (const File* file = find(symbol)) {
+            result.lock = std::shared_lock<std::shared_mutex>(file->remap_mutex);
+            result.view = file->last(count);
+        }
+        return result;
+    }
+
+    std::optional<int64_t> TickStore::firstTimestamp(std::string_view symbol) const {
+        const Range first = newest(symbol, std::numeric_limits<size_t>::max());
+        if (first.records().empty()) {
+            return std::nullopt;
+        }
+        return first.records()[0].timestamp_ns;
+    }
+
+    std::optional<int64_t> TickStore::lastTimestamp(std::string_view symbol) const {
+        const Range last = newest(symbol, 1);
+        if (last.records().empty()) {
+            return std::nullopt;
+        }
+        return last.records()[0].timestamp_ns;
+    }
+
+    TickStore::File* TickStore::find(std::string_view symbol) const {
+        File* const* file = files.find(symbolKey(symbol));
+        return file ? *file : nullptr;
+    }
+
+    TickStore::File* TickStore::findOrOpen(SymbolKey key) {
+        {
+            std::shared_lock<std::shared_mutex> lock(files_mutex);
+            if (File* const* file = files.find(key)) {
+                return *file;
+            }
+        }
+        return open(key);
+    }
+
+    TickStore::File* TickStore::open(SymbolKey key) {
+        if (key == NO_SYMBOL) {
+            return nullptr;
+        }
+
+        // A failed open is remembered as null so it isn't retried on every tick
+        const std::string symbol(symbolName(key));
+        std::unique_ptr<File> file;
+        if (isStorableSymbol(symbol)) {
+            try {
+                file = std::make_unique<File>((std::filesystem::path(directory) / (symbol + ".ticks")).string(), retention_ns);
+            }
+            catch (const std::exception& e) {
+                spdlog::warn("Not storing ticks for {}: {}", symbol, e.what());
+            }
+        }
+
+        std::unique_lock<std::shared_mutex> lock(files_mutex);
+        if (File* const* existing = files.find(key)) {
+            return *existing; // Another writer opened it first; ours is closed unused
+        }
+        files.insert(key, file.get());
+        return owned.emplace_back(std::move(file)).get();
+    }
+}
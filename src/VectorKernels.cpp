@@ -0,0 +1,167 @@
+#include "VectorKernels.h"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define TICKR_SIMD_AVX
+#elif defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TICKR_SIMD_SSE2
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define TICKR_SIMD_NEON
+#endif
+
+
+namespace StockTracker {
+    namespace {
+        double dotScalar(const double* a, const double* b, size_t n) {
+            double sum = 0.0;
+            for (size_t i = 0; i < n; ++i) {
+                sum += a[i] * b[i];
+            }
+            return sum;
+        }
+
+        void updateScalar(double* row, double xa, const double* a, double xb, const double* b, size_t n) {
+            for (size_t i = 0; i < n; ++i) {
+                row[i] += xa * a[i] - xb * b[i];
+            }
+        }
+
+        // Four independent accumulators hide the add latency; the tail is done in scalar code.
+#if defined(TICKR_SIMD_AVX)
+        constexpr const char* SIMD_NAME = "avx";
+
+        double dotSimd(const double* a, const double* b, size_t n) {
+            __m256d s0 = _mm256_setzero_pd();
+            __m256d s1 = _mm256_setzero_pd();
+            __m256d s2 = _mm256_setzero_pd();
+            __m256d s3 = _mm256_setzero_pd();
+            size_t i = 0;
+            for (; i + 16 <= n; i += 16) {
+                s0 = _mm256_add_pd(s0, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+                s1 = _mm256_add_pd(s1, _mm256_mul_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4)));
+                s2 = _mm256_add_pd(s2, _mm256_mul_pd(_mm256_loadu_pd(a + i + 8), _mm256_loadu_pd(b + i + 8)));
+                s3 = _mm256_add_pd(s3, _mm256_mul_pd(_mm256_loadu_pd(a + i + 12), _mm256_loadu_pd(b + i + 12)));
+            }
+            for (; i + 4 <= n; i += 4) {
+                s0 = _mm256_add_pd(s0, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+            }
+            const __m256d s = _mm256_add_pd(_mm256_add_pd(s0, s1), _mm256_add_pd(s2, s3));
+            const __m128d pair = _mm_add_pd(_mm256_castpd256_pd128(s), _mm256_extractf128_pd(s, 1));
+            double sum = _mm_cvtsd_f64(_mm_add_sd(pair, _mm_unpackhi_pd(pair, pair)));
+            for (; i < n; ++i) {
+                sum += a[i] * b[i];
+            }
+            return sum;
+        }
+
+        void updateSimd(double* row, double xa, const double* a, double xb, const double* b, size_t n) {
+            const __m256d va = _mm256_set1_pd(xa);
+            const __m256d vb = _mm256_set1_pd(xb);
+            size_t i = 0;
+            for (; i + 4 <= n; i += 4) {
+                const __m256d delta = _mm256_sub_pd(_mm256_mul_pd(va, _mm256_loadu_pd(a + i)),
+                    _mm256_mul_pd(vb, _mm256_loadu_pd(b + i)));
+                _mm256_storeu_pd(row + i, _mm256_add_pd(_mm256_loadu_pd(row + i), delta));
+            }
+            for (; i < n; ++i) {
+                row[i] += xa * a[i] - xb * b[i];
+            }
+        }
+#elif defined(TICKR_SIMD_SSE2)
+        constexpr const char* SIMD_NAME = "sse2";
+
+        double dotSimd(const double* a, const double* b, size_t n) {
+            __m128d s0 = _mm_setzero_pd();
+            __m128d s1 = _mm_setzero_pd();
+            __m128d s2 = _mm_setzero_pd();
+            __m128d s3 = _mm_setzero_pd();
+            size_t i = 0;
+            for (; i + 8 <= n; i += 8) {
+                s0 = _mm_add_pd(s0, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+                s1 = _mm_add_pd(s1, _mm_mul_pd(_mm_loadu_pd(a + i + 2), _mm_loadu_pd(b + i + 2)));
+                s2 = _mm_add_pd(s2, _mm_mul_pd(_mm_loadu_pd(a + i + 4), _mm_loadu_pd(b + i + 4)));
+                s3 = _mm_add_pd(s3, _mm_mul_pd(_mm_loadu_pd(a + i + 6), _mm_loadu_pd(b + i + 6)));
+            }
+            for (; i + 2 <= n; i += 2) {
+                s0 = _mm_add_pd(s0, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+            }
+            const __m128d pair = _mm_add_pd(_mm_add_pd(s0, s1), _mm_add_pd(s2, s3));
+            double sum = _mm_cvtsd_f64(_mm_add_sd(pair, _mm_unpackhi_pd(pair, pair)));
+            for (; i < n; ++i) {
+                sum += a[i] * b[i];
+            }
+            return sum;
+        }
+
+        void updateSimd(double* row, double xa, const double* a, double xb, const double* b, size_t n) {
+            const __m128d va = _mm_set1_pd(xa);
+            const __m128d vb = _mm_set1_pd(xb);
+            size_t i = 0;
+            for (; i + 2 <= n; i += 2) {
+                const __m128d delta = _mm_sub_pd(_mm_mul_pd(va, _mm_loadu_pd(a + i)), _mm_mul_pd(vb, _mm_loadu_pd(b + i)));
+                _mm_storeu_pd(row + i, _mm_add_pd(_mm_loadu_pd(row + i), delta));
+            }
+            for (; i < n; ++i) {
+                row[i] += xa * a[i] - xb * b[i];
+            }
+        }
+#elif defined(TICKR_SIMD_NEON)
+        constexpr const char* SIMD_NAME = "neon";
+
+        double dotSimd(const double* a, const double* b, size_t n) {
+            float64x2_t s0 = vdupq_n_f64(0.0);
+            float64x2_t s1 = vdupq_n_f64(0.0);
+            float64x2_t s2 = vdupq_n_f64(0.0);
+            float64x2_t s3 = vdupq_n_f64(0.0);
+            size_t i = 0;
+            for (; i + 8 <= n; i += 8) {
+                s0 = vfmaq_f64(s0, vld1q_f64(a + i), vld1q_f64(b + i));
+                s1 = vfmaq_f64(s1, vld1q_f64(a + i + 2), vld1q_f64(b + i + 2));
+                s2 = vfmaq_f64(s2, vld1q_f64(a + i + 4), vld1q_f64(b + i + 4));
+                s3 = vfmaq_f64(s3, vld1q_f64(a + i + 6), vld1q_f64(b + i + 6));
+            }
+            for (; i + 2 <= n; i += 2) {
+                s0 = vfmaq_f64(s0, vld1q_f64(a + i), vld1q_f64(b + i));
+            }
+            double sum = vaddvq_f64(vaddq_f64(vaddq_f64(s0, s1), vaddq_f64(s2, s3)));
+            for (; i < n; ++i) {
+                sum += a[i] * b[i];
+            }
+            return sum;
+        }
+
+        void updateSimd(double* row, double xa, const double* a, double xb, const double* b, size_t n) {
+            size_t i = 0;
+            for (; i + 2 <= n; i += 2) {
+                const float64x2_t added = vfmaq_n_f64(vld1q_f64(row + i), vld1q_f64(a + i), xa);
+                vst1q_f64(row + i, vfmsq_n_f64(added, vld1q_f64(b + i), xb));
+            }
+            for (; i < n; ++i) {
+                row[i] += xa * a[i] - xb * b[i];
+            }
+        }
+#else
+        constexpr const char* SIMD_NAME = "scalar";
+
+        double dotSimd(const double* a, const double* b, size_t n) {
+            return dotScalar(a, b, n);
+        }
+
+        void updateSimd(double* row, double xa, const double* a, double xb, const double* b, size_t n) {
+            updateScalar(row, xa, a, xb, b, n);
+        }
+#endif
+    }
+
+    const VectorKernels& VectorKernels::scalar() {
+        static const VectorKernels kernels{ "scalar", &dotScalar, &updateScalar };
+        return kernels;
+    }
+
+    const VectorKernels& VectorKernels::simd() {
+        static const VectorKernels kernels{ SIMD_NAME, &dotSimd, &updateSimd };
+        return kernels;
+    }
+}
@@ -0,0 +1,90 @@
+#include "WireFormat.h"
+#include <algorithm>
+
+
+namespace StockTracker {
+    namespace Wire {
+        namespace {
+            template <typename T>
+            void store(std::string& out, size_t at, T value) {
+                std::memcpy(&out[at], &value, sizeof(T));
+            }
+
+            void storeText(std::string& out, size_t at, std::string_view text, size_t capacity) {
+                std::memcpy(&out[at], text.data(), std::min(text.size(), capacity));
+            }
+
+            void writeHeader(std::string& out, RecordType type, size_t count, std::string_view symbol) {
+                out.assign(HEADER_SIZE + count * RECORD_SIZE, '\0');
+                store<uint32_t>(out, 0, MAGIC);
+                store<uint16_t>(out, 4, VERSION);
+                store<uint16_t>(out, 6, static_cast<uint16_t>(type));
+                store<uint32_t>(out, 8, static_cast<uint32_t>(count));
+                storeText(out, 16, symbol, 8);
+            }
+
+            void writeRecord(std::string& out, size_t at, const QuoteTick& tick) {
+                storeText(out, at, tick.symbol, 8);
+                storeText(out, at + 8, tick.currency, 4);
+                store<uint32_t>(out, at + 12, HasChangePercent | (tick.volume > 0.0 ? HasVolume : 0u)
+                    | (tick.sequence > 0 ? HasSequence : 0u));
+                store<int64_t>(out, at + 16, tick.timestamp_ns);
+                store<double>(out, at + 24, tick.price);
+                store<double>(out, at + 32, tick.change_percent);
+                store<double>(out, at + 40, tick.volume);
+                store<uint64_t>(out, at + 48, tick.sequence);
+            }
+        }
+
+        QuoteTick QuoteView::tick() const {
+            QuoteTick tick;
+            tick.symbol = symbol();
+            tick.key = symbolKey(tick.symbol);
+            tick.currency = currency();
+            tick.timestamp_ns = timestampNs();
+            tick.price = price();
+            tick.change_percent = (flags() & HasChangePercent) ? changePercent() : 0.0;
+            tick.volume = (flags() & HasVolume) ? volume() : 0.0;
+            tick.sequence = (flags() & HasSequence) ? sequence() : 0;
+            return tick;
+        }
+
+        bool FrameView::isBinary(const void* data, size_t size) {
+            return size >= sizeof(uint32_t) && detail::load<uint32_t>(static_cast<const unsigned char*>(data)) == MAGIC;
+        }
+
+        std::optional<FrameView> FrameView::parse(const void* data, size_t size) {
+            if (size < HEADER_SIZE || !isBinary(data, size)) {
+                return std::nullopt;
+            }
+
+            const auto* base = static_cast<const unsigned char*>(data);
+            const uint16_t version = detail::load<uint16_t>(base + 4);
+            if (version != VERSION && version != 1) {
+                return std::nullopt;
+            }
+            const size_t record_size = version == 1 ? RECORD_SIZE_V1 : RECORD_SIZE;
+
+            const auto type = static_cast<RecordType>(detail::load<uint16_t>(base + 6));
+            const size_t count = detail::load<uint32_t>(base + 8);
+            if ((type != RecordType::Quote && type != RecordType::PriceHistory)
+                || count > (size - HEADER_SIZE) / record_size
+                || size != HEADER_SIZE + count * record_size) {
+                return std::nullopt;
+            }
+            return FrameView(base, count, record_size);
+        }
+
+        void encodeQuote(const QuoteTick& tick, std::string& out) {
+            writeHeader(out, RecordType::Quote, 1, {});
+            writeRecord(out, HEADER_SIZE, tick);
+        }
+
+        void encodeHistory(std::string_view symbol, const std::vector<QuoteTick>& ticks, std::string& out) {
+            writeHeader(out, RecordType::PriceHistory, ticks.size(), symbol);
+            for (size_t i = 0; i < ticks.size(); ++i) {
+                writeRecord(out, HEADER_SIZE + i * RECORD_SIZE, ticks[i]);
+            }
+        }
+    }
+}
@@ -0,0 +1,91 @@
+#include "WorkerPool.h"
+#include "ThreadAffinity.h"
+#include <spdlog/spdlog.h>
+#include <system_error>
+
+
+namespace StockTracker {
+
+    WorkerPool::WorkerPool(size_t workers, std::optional<size_t> first_core) {
+        this->workers.reserve(workers);
+        for (size_t t = 0; t < workers; ++t) {
+            const auto core = first_core ? std::optional<size_t>(*first_core + t) : std::nullopt;
+            try {
+                this->workers.emplace_back(&WorkerPool::work, this, core);
+            }
+            catch (const std::system_error& e) {
+                spdlog::warn("Running with {} of {} worker threads: {}", t, workers, e.what());
+                break;
+            }
+        }
+    }
+
+    WorkerPool::~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        start.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    void WorkerPool::run(size_t count, const std::function<void(size_t)>& task) {
+        if (workers.empty() || count <= 1) {
+            for (size_t i = 0; i < count; ++i) {
+                task(i);
+            }
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            this->task = &task;
+            this->count = count;
+            next.store(0, std::memory_order_relaxed);
+            busy = workers.size();
+            ++generation;
+        }
+        start.notify_all();
+
+        for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < count;) {
+            task(i);
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this] { return busy == 0; });
+        this->task = nullptr;
+    }
+
+    void WorkerPool::work(std::optional<size_t> core) {
+        if (core && !pinCurrentThread(*core)) {
+            spdlog::warn("Could not pin a worker thread to core {}", *core % coreCount());
+        }
+
+        size_t seen = 0;
+        for (;;) {
+            const std::function<void(size_t)>* current = nullptr;
+            size_t total = 0;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                start.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping) {
+                    return;
+                }
+                seen = generation;
+                current = task;
+                total = count;
+            }
+
+            for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < total;) {
+                (*current)(i);
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--busy == 0) {
+                done.notify_one();
+            }
+        }
+    }
+}
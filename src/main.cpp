@@ -1,11 +1,36 @@
 #include "CliApp.h"
 #include "MockData.h"
+#include <fstream>
 #include <iostream>
+#include <stdexcept>
+
+int main(int argc, char* argv[]) {
+	StockTracker::CliConfig config;
+	try {
+		config = StockTracker::CliConfig::fromArgs(argc, argv);
+	}
+	catch (const std::invalid_argument& e) {
+		std::cerr << "Error: " << e.what() << std::endl;
+		StockTracker::CliConfig::printUsage(argv[0]);
+		return 1;
+	}
 
-int main() {
 	try {
 		// Create instance of CLI app
-		StockTracker::CliApp app;
+		StockTracker::CliApp app(config);
+
+		// Scripted runs print only their results and exit with their status
+		if (config.batch) {
+			if (config.script_path.empty()) {
+				return app.runBatch(std::cin);
+			}
+			std::ifstream script(config.script_path);
+			if (!script) {
+				std::cerr << "Error: cannot open script " << config.script_path << std::endl;
+				return 1;
+			}
+			return app.runBatch(script);
+		}
 
 		// Print the welcome message
 		app.printWelcomeMessage();